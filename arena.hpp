@@ -1,44 +1,290 @@
 #pragma once
 
+#include <atomic>
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <mutex>
+#include <new>
 
 #include "types.hpp"
 
 // note: default page size in win32
 #define BASE_REGION_CAP 4096
 
+// note: the virtual backend only reserves address space up front, pages are committed on demand
+#ifndef ARENA_VM_RESERVE
+#define ARENA_VM_RESERVE (sizeof(void *) == 8 ? ((size_t)1 << 36) : ((size_t)1 << 28))
+#endif
+#define ARENA_VM_COMMIT_STEP (64 * 1024)
+
+// Decay policy of arena_reset: the first regions and bytes stay hot so a per-frame arena doesn't
+// hit the os every frame, anything past them goes back once it sat unused for a few resets
+#define ARENA_KEEP_REGIONS 1
+#define ARENA_KEEP_BYTES (256 * 1024)
+#define ARENA_DECAY_RESETS 16
+
+// Size classes for the optional free lists: 16, 32, ... 4096 bytes
+#define ARENA_FREE_MIN 16
+#define ARENA_FREE_CLASSES 9
+#define ARENA_FREE_MAX (ARENA_FREE_MIN << (ARENA_FREE_CLASSES - 1))
+
+#define ARENA_MAX_TAGS 16
+
+// Allocations above this get a mapping of their own instead of a region
+#define ARENA_LARGE_THRESHOLD (128 * 1024)
+#define ARENA_HUGE_PAGE (2 * 1024 * 1024)
+
+#if defined(_WIN32)
+// note: windows.h clashes with raylib.h, so only declare what we need
+extern "C" {
+    __declspec(dllimport) void *__stdcall VirtualAlloc(void *addr, size_t size, unsigned long type, unsigned long protect);
+    __declspec(dllimport) int __stdcall VirtualFree(void *addr, size_t size, unsigned long type);
+}
+#define ARENA_HAS_VM 1
+#elif defined(__EMSCRIPTEN__)
+// note: wasm has a single linear memory, nothing to reserve
+#define ARENA_HAS_VM 0
+#else
+#include <sys/mman.h>
+#define ARENA_HAS_VM 1
+#endif
+
+enum ArenaBackend {
+    ARENA_BACKEND_DEFAULT, // virtual when the platform has it, regions otherwise
+    ARENA_BACKEND_REGIONS,
+    ARENA_BACKEND_VIRTUAL,
+};
+
 struct ArenaRegion {
     u8 *mem;
     size_t off;
-    size_t size;
+    size_t size;     // committed bytes
+    size_t reserved; // same as size for malloc regions
+    bool virt;
+    i64 id;          // never reused, a freed region's header can come back from malloc
+    size_t high;     // most bytes used in a cycle lately, decays after decay_resets resets
+    i64 epoch;       // reset_cnt when high was set
     ArenaRegion *next;
     ArenaRegion *prev;
 };
 
+struct ArenaLarge {
+    ArenaLarge *next;
+    ArenaLarge *prev;
+    size_t size; // the whole mapping, header included
+    size_t amt;
+    i64 seq;
+};
+
+enum ArenaFit {
+    ARENA_FIT_BEST, // smallest region or region tail that still fits, O(log regions)
+    ARENA_FIT_NEXT, // walk forward from current, tails left behind are lost until reset
+};
+
+struct ArenaTagStats {
+    const char *name;
+    i64 bytes;  // allocated under the tag since the arena was created
+    i64 count;
+    i64 cycle;  // allocated since the last reset
+    i64 peak;   // highest cycle seen
+};
+
+struct ArenaTags {
+    ArenaTagStats items[ARENA_MAX_TAGS];
+    i32 count;
+};
+
 struct GrowingArena {
     ArenaRegion *current;
+    ArenaBackend backend;
+    ArenaFit fit;
+    // Every region but current, sorted by free space
+    ArenaRegion **index;
+    i32 index_cnt;
+    i32 index_cap;
+    // Last allocation handed out from current, arena_realloc can grow it in place
+    u8 *top;
+    // Marks not rewound yet. While there is one, the tails of older regions are left alone,
+    // arena_rewind only drops what sits past the mark in the region list.
+    i32 marks;
+    // Round small allocations up to a size class and reuse blocks given back with arena_release.
+    // note: set it before the first allocation, release needs the same rounding the alloc got
+    bool recycle;
+    void *free_lists[ARENA_FREE_CLASSES];
+    // Allocations get attributed to this tag when set, see ArenaTag
+    const char *tag;
+    ArenaTags *tags;
+    // Live large allocations, newest first
+    ArenaLarge *large;
+    i64 large_seq;
+    i64 region_seq;
+    size_t large_threshold; // 0 means ARENA_LARGE_THRESHOLD
+    size_t large_limit;     // large_threshold fixed at the first allocation, release relies on it
+    bool huge_pages;        // ask for transparent huge pages on large mappings (linux only)
+    // Decay policy, 0 means the ARENA_KEEP_REGIONS/ARENA_KEEP_BYTES/ARENA_DECAY_RESETS default
+    i32 keep_regions;
+    size_t keep_bytes;
+    i32 decay_resets;
 
     // Only for information
-    i32 used;
-    i32 total;
-    i32 wasted;
+    i64 used;
+    i64 total;
+    i64 wasted;
     i32 region_cnt;
+    i64 saved;   // bytes arena_realloc didn't have to copy
+    i64 padding; // bytes skipped to honour alignment
+    i64 reused;  // bytes served from the free lists
+    i64 peak_used;
+    i64 peak_total;
+    i64 alloc_cnt;
+    i64 realloc_cnt;
+    i64 reset_cnt;
+    i64 large_cnt;
+    i64 large_used;
+    i64 large_total; // mapped for large allocations, not part of total
+    i64 released;    // bytes arena_reset gave back to the os
 };
 
+inline u8 *arena_vm_reserve(size_t size) {
+#if !ARENA_HAS_VM
+    (void)size;
+    return NULL;
+#elif defined(_WIN32)
+    // MEM_RESERVE, PAGE_NOACCESS
+    return (u8 *)VirtualAlloc(NULL, size, 0x2000, 0x01);
+#else
+    void *mem = mmap(NULL, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    return mem == MAP_FAILED ? NULL : (u8 *)mem;
+#endif
+}
+
+inline bool arena_vm_commit(u8 *mem, size_t size) {
+#if !ARENA_HAS_VM
+    (void)mem; (void)size;
+    return false;
+#elif defined(_WIN32)
+    // MEM_COMMIT, PAGE_READWRITE
+    return VirtualAlloc(mem, size, 0x1000, 0x04) != NULL;
+#else
+    return mprotect(mem, size, PROT_READ | PROT_WRITE) == 0;
+#endif
+}
+
+inline void arena_vm_decommit(u8 *mem, size_t size) {
+#if !ARENA_HAS_VM
+    (void)mem; (void)size;
+#elif defined(_WIN32)
+    // MEM_DECOMMIT
+    VirtualFree(mem, size, 0x4000);
+#else
+    madvise(mem, size, MADV_DONTNEED);
+    mprotect(mem, size, PROT_NONE);
+#endif
+}
+
+inline void arena_vm_release(u8 *mem, size_t size) {
+#if !ARENA_HAS_VM
+    (void)mem; (void)size;
+#elif defined(_WIN32)
+    // MEM_RELEASE wants a size of 0
+    (void)size;
+    VirtualFree(mem, 0, 0x8000);
+#else
+    munmap(mem, size);
+#endif
+}
+
+inline u8 *arena_large_map(size_t size, bool huge) {
+#if !ARENA_HAS_VM
+    (void)huge;
+    return (u8 *)malloc(size);
+#elif defined(_WIN32)
+    // note: large pages need SeLockMemoryPrivilege, so huge is ignored here
+    (void)huge;
+    // MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE
+    return (u8 *)VirtualAlloc(NULL, size, 0x3000, 0x04);
+#else
+    void *mem = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED) return NULL;
+#if defined(MADV_HUGEPAGE)
+    if (huge && size >= ARENA_HUGE_PAGE) madvise(mem, size, MADV_HUGEPAGE);
+#else
+    (void)huge;
+#endif
+    return (u8 *)mem;
+#endif
+}
+
+inline void arena_large_unmap(u8 *mem, size_t size) {
+#if !ARENA_HAS_VM
+    (void)size;
+    free(mem);
+#else
+    arena_vm_release(mem, size);
+#endif
+}
+
+inline bool arena_uses_vm(GrowingArena *self) {
+    return ARENA_HAS_VM && self->backend != ARENA_BACKEND_REGIONS;
+}
+
+// Commits pages of a virtual region until `end` bytes are usable
+inline bool arena_region_commit(GrowingArena *self, ArenaRegion *region, size_t end) {
+    if (!region->virt || end > region->reserved) return false;
+    if (end <= region->size) return true;
+
+    size_t new_size = (end + ARENA_VM_COMMIT_STEP - 1) / ARENA_VM_COMMIT_STEP * ARENA_VM_COMMIT_STEP;
+    if (new_size > region->reserved) new_size = region->reserved;
+
+    if (!arena_vm_commit(region->mem + region->size, new_size - region->size)) return false;
+
+    self->total += new_size - region->size;
+    region->size = new_size;
+    return true;
+}
+
 inline ArenaRegion *arena_region_create(GrowingArena *self, size_t required_size) {
     ArenaRegion *region = (ArenaRegion *)malloc(sizeof(ArenaRegion));
 
-    region->size = required_size > BASE_REGION_CAP ? required_size : BASE_REGION_CAP;
-    region->mem = (u8 *)malloc(region->size);
     region->off = 0;
+    region->size = 0;
+    region->virt = false;
+    region->id = self->region_seq++;
+    region->high = 0;
+    region->epoch = self->reset_cnt;
     region->next = NULL;
 
+    if (arena_uses_vm(self)) {
+        size_t step = ARENA_VM_COMMIT_STEP;
+        size_t reserve = required_size > ARENA_VM_RESERVE ? (required_size + step - 1) / step * step : ARENA_VM_RESERVE;
+        region->mem = arena_vm_reserve(reserve);
+        if (region->mem != NULL) {
+            region->virt = true;
+            region->reserved = reserve;
+            if (!arena_region_commit(self, region, required_size > BASE_REGION_CAP ? required_size : BASE_REGION_CAP)) {
+                arena_vm_release(region->mem, reserve);
+                region->virt = false;
+            }
+        }
+    }
+
+    // note: also the fallback when the reservation fails (e.g. ulimit -v)
+    if (!region->virt) {
+        region->size = required_size > BASE_REGION_CAP ? required_size : BASE_REGION_CAP;
+        region->reserved = region->size;
+        region->mem = (u8 *)malloc(region->size);
+        self->total += region->size;
+    }
+
+    // note: goes right after current, the empty regions past it stay linked
     if (self->current != NULL) {
         region->prev = self->current;
+        region->next = self->current->next;
+        if (region->next != NULL) region->next->prev = region;
         self->current->next = region;
     } else {
         region->prev = NULL;
@@ -49,84 +295,959 @@ inline ArenaRegion *arena_region_create(GrowingArena *self, size_t required_size
     return region;
 }
 
-template <typename T>
-static T *arena_alloc(GrowingArena *self, size_t amt) {
+inline void arena_region_destroy(ArenaRegion *region) {
+    if (region->virt) {
+        arena_vm_release(region->mem, region->reserved);
+    } else {
+        free(region->mem);
+    }
+    free(region);
+}
+
+inline size_t arena_region_free(ArenaRegion *region) {
+    return region->reserved - region->off;
+}
+
+// First slot in the index with at least `amt` free bytes
+inline i32 arena_index_lower_bound(GrowingArena *self, size_t amt) {
+    i32 lo = 0;
+    i32 hi = self->index_cnt;
+    while (lo < hi) {
+        i32 mid = (lo + hi) / 2;
+        if (arena_region_free(self->index[mid]) < amt) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+inline void arena_index_insert(GrowingArena *self, ArenaRegion *region) {
+    if (self->index_cnt == self->index_cap) {
+        self->index_cap = self->index_cap == 0 ? 16 : self->index_cap * 2;
+        self->index = (ArenaRegion **)realloc(self->index, sizeof(ArenaRegion *) * self->index_cap);
+    }
+
+    i32 at = arena_index_lower_bound(self, arena_region_free(region));
+    memmove(self->index + at + 1, self->index + at, sizeof(ArenaRegion *) * (self->index_cnt - at));
+    self->index[at] = region;
+    self->index_cnt += 1;
+}
+
+inline void arena_index_remove(GrowingArena *self, ArenaRegion *region) {
+    i32 at = arena_index_lower_bound(self, arena_region_free(region));
+    while (self->index[at] != region) at += 1;
+
+    memmove(self->index + at, self->index + at + 1, sizeof(ArenaRegion *) * (self->index_cnt - at - 1));
+    self->index_cnt -= 1;
+}
+
+inline void arena_index_rebuild(GrowingArena *self) {
+    self->index_cnt = 0;
+    if (self->fit != ARENA_FIT_BEST || self->current == NULL) return;
+
+    ArenaRegion *region = self->current;
+    while (region->prev != NULL) region = region->prev;
+    for (; region != NULL; region = region->next) {
+        if (region != self->current) arena_index_insert(self, region);
+    }
+}
+
+// Bytes stuck in the tails of regions that aren't current anymore, relative to what is committed
+inline f32 arena_fragmentation(GrowingArena *self) {
+    if (self->total == 0) return 0;
+
+    i64 stranded = 0;
+    for (ArenaRegion *region = self->current; region != NULL; region = region->prev) {
+        if (region != self->current && region->off > 0 && region->size > region->off) {
+            stranded += region->size - region->off;
+        }
+    }
+    return (f32)stranded / (f32)self->total;
+}
+
+// note: changing large_threshold only takes effect after arena_free, live blocks were sorted with the old one
+inline bool arena_is_large(GrowingArena *self, size_t amt) {
+    return amt > (self->large_limit != 0 ? self->large_limit : ARENA_LARGE_THRESHOLD);
+}
+
+// The header sits at the start of the mapping and a pointer to it right before the block
+inline void *arena_alloc_large(GrowingArena *self, size_t amt, size_t align) {
+    if (align < sizeof(void *)) align = sizeof(void *);
+    size_t head = (sizeof(ArenaLarge) + sizeof(void *) + align - 1) & ~(align - 1);
+    size_t page = BASE_REGION_CAP;
+    size_t size = (head + amt + page - 1) / page * page;
+
+    u8 *mem = arena_large_map(size, self->huge_pages);
+    if (mem == NULL) return NULL;
+
+    ArenaLarge *large = (ArenaLarge *)mem;
+    large->size = size;
+    large->amt = amt;
+    large->seq = self->large_seq++;
+    large->prev = NULL;
+    large->next = self->large;
+    if (large->next != NULL) large->next->prev = large;
+    self->large = large;
+
+    u8 *ptr = mem + head;
+    ((ArenaLarge **)ptr)[-1] = large;
+
+    self->large_cnt += 1;
+    self->large_used += amt;
+    self->large_total += size;
+    return ptr;
+}
+
+inline void arena_large_free(GrowingArena *self, ArenaLarge *large) {
+    if (large->prev != NULL) {
+        large->prev->next = large->next;
+    } else {
+        self->large = large->next;
+    }
+    if (large->next != NULL) large->next->prev = large->prev;
+
+    self->large_cnt -= 1;
+    self->large_used -= large->amt;
+    self->large_total -= large->size;
+    arena_large_unmap((u8 *)large, large->size);
+}
+
+inline size_t arena_align_pad(ArenaRegion *region, size_t align) {
+    return (size_t)(-(uintptr_t)(region->mem + region->off)) & (align - 1);
+}
+
+inline i32 arena_free_class(size_t size) {
+    if (size > ARENA_FREE_MAX) return -1;
+
+    i32 cls = 0;
+    while (((size_t)ARENA_FREE_MIN << cls) < size) cls += 1;
+    return cls;
+}
+
+// The size a block really occupies once the free list rounding is applied
+inline size_t arena_block_size(GrowingArena *self, size_t size) {
+    if (!self->recycle) return size;
+    i32 cls = arena_free_class(size);
+    return cls < 0 ? size : (size_t)ARENA_FREE_MIN << cls;
+}
+
+inline void arena_note_alloc(GrowingArena *self, size_t amt) {
+    self->alloc_cnt += 1;
+    if (self->used > self->peak_used) self->peak_used = self->used;
+    if (self->total > self->peak_total) self->peak_total = self->total;
+
+    if (self->tag == NULL) return;
+
+    if (self->tags == NULL) {
+        self->tags = (ArenaTags *)calloc(1, sizeof(ArenaTags));
+    }
+
+    ArenaTags *tags = self->tags;
+    ArenaTagStats *stats = NULL;
+    for (i32 i = 0; i < tags->count; i += 1) {
+        // note: tags are expected to be string literals, so the pointer is enough most of the time
+        if (tags->items[i].name == self->tag || strcmp(tags->items[i].name, self->tag) == 0) {
+            stats = &tags->items[i];
+            break;
+        }
+    }
+    if (stats == NULL) {
+        if (tags->count == ARENA_MAX_TAGS) return;
+        stats = &tags->items[tags->count++];
+        stats->name = self->tag;
+    }
+
+    stats->bytes += amt;
+    stats->count += 1;
+    stats->cycle += amt;
+    if (stats->cycle > stats->peak) stats->peak = stats->cycle;
+}
+
+// align has to be a power of two, e.g. 16/32/64 for simd loads or a whole cache line
+inline void *arena_alloc_aligned(GrowingArena *self, size_t amt, size_t align) {
+    assert(align != 0 && (align & (align - 1)) == 0 && "Alignment must be a power of two!");
 
     if (self->current == NULL) {
-        memset(self, 0, sizeof(GrowingArena));
-        self->current = arena_region_create(self, amt);
-        self->total += self->current->size;
+        self->used = 0;
+        self->total = 0;
+        self->wasted = 0;
+        self->region_cnt = 0;
+        self->saved = 0;
+        self->padding = 0;
+        self->reused = 0;
+        self->peak_used = 0;
+        self->peak_total = 0;
+        self->alloc_cnt = 0;
+        self->realloc_cnt = 0;
+        self->reset_cnt = 0;
+        self->large_cnt = 0;
+        self->large_used = 0;
+        self->large_total = 0;
+        self->released = 0;
+        self->top = NULL;
+        memset(self->free_lists, 0, sizeof(self->free_lists));
+        self->large_limit = self->large_threshold != 0 ? self->large_threshold : ARENA_LARGE_THRESHOLD;
+        self->current = arena_region_create(self, arena_is_large(self, amt) ? 0 : amt + align - 1);
     }
 
-    if (self->current->off + amt > self->current->size) {
-        ArenaRegion *region = self->current;
+    if (arena_is_large(self, amt)) {
+        // note: no falling back to a region, arena_release would take the block for a mapping
+        void *mem = arena_alloc_large(self, amt, align);
+        if (mem != NULL) arena_note_alloc(self, amt);
+        return mem;
+    }
 
-        while (region != NULL && region->off + amt > region->size) {
-            region = region->next;
+    if (self->recycle) {
+        amt = arena_block_size(self, amt);
+        i32 cls = arena_free_class(amt);
+        u8 *block = cls < 0 ? NULL : (u8 *)self->free_lists[cls];
+        if (block != NULL && ((uintptr_t)block & (align - 1)) == 0) {
+            // note: blocks can come from u8 allocations, so the link is read unaligned
+            memcpy(&self->free_lists[cls], block, sizeof(void *));
+            self->used += amt;
+            self->wasted -= amt;
+            self->reused += amt;
+            arena_note_alloc(self, amt);
+            return block;
         }
+    }
 
-        if (region == NULL) {
-            self->wasted += self->current->size - self->current->off;
-            self->current = arena_region_create(self, amt);
-            self->total += self->current->size;
+    size_t pad = arena_align_pad(self->current, align);
+    if (self->current->off + pad + amt > self->current->size &&
+        !arena_region_commit(self, self->current, self->current->off + pad + amt)) {
+        if (self->fit == ARENA_FIT_NEXT) {
+            ArenaRegion *region = self->current;
+
+            while (region != NULL && region->off + arena_align_pad(region, align) + amt > region->reserved) {
+                region = region->next;
+            }
+
+            if (region == NULL) {
+                self->wasted += self->current->size - self->current->off;
+                self->current = arena_region_create(self, amt + align - 1);
+            } else {
+                self->current = region;
+                arena_region_commit(self, region, region->off + arena_align_pad(region, align) + amt);
+            }
         } else {
-            self->current = region;
+            i32 at = arena_index_lower_bound(self, amt + align - 1);
+            ArenaRegion *region = at < self->index_cnt ? self->index[at] : NULL;
+            if (region != NULL && region->off > 0 && self->marks > 0) region = NULL;
+            if (region != NULL) {
+                size_t end = region->off + arena_align_pad(region, align) + amt;
+                if (end > region->size && !arena_region_commit(self, region, end)) region = NULL;
+            }
+
+            // Rather than any empty region take the next one in the list, so every cycle after a reset
+            // walks the same regions and the rest can decay
+            ArenaRegion *next = self->current->next;
+            if ((region == NULL || region->off == 0) && next != NULL && next->off == 0 &&
+                arena_align_pad(next, align) + amt <= next->reserved &&
+                (amt + align - 1 <= next->size || arena_region_commit(self, next, arena_align_pad(next, align) + amt))) {
+                region = next;
+            }
+
+            if (region != NULL && region->off > 0) {
+                // Tail of an older region: current keeps going and so does top
+                arena_index_remove(self, region);
+                size_t side_pad = arena_align_pad(region, align);
+                u8 *mem = region->mem + region->off + side_pad;
+                region->off += side_pad + amt;
+                arena_index_insert(self, region);
+
+                self->used += amt;
+                self->padding += side_pad;
+                arena_note_alloc(self, amt);
+                return mem;
+            }
+
+            arena_index_insert(self, self->current);
+            if (region == NULL) {
+                self->current = arena_region_create(self, amt + align - 1);
+            } else {
+                // An empty region becomes current, move it right after the old one so
+                // everything past current stays empty (arena_rewind relies on it)
+                arena_index_remove(self, region);
+                if (region->prev != NULL) region->prev->next = region->next;
+                if (region->next != NULL) region->next->prev = region->prev;
+                region->prev = self->current;
+                region->next = self->current->next;
+                if (region->next != NULL) region->next->prev = region;
+                self->current->next = region;
+                self->current = region;
+            }
         }
+        pad = arena_align_pad(self->current, align);
     }
 
-    T *mem = (T *)(self->current->mem + self->current->off);
-    self->current->off += amt;
+    u8 *mem = self->current->mem + self->current->off + pad;
+    self->current->off += pad + amt;
+    self->top = mem;
 
     self->used += amt;
+    self->padding += pad;
+    arena_note_alloc(self, amt);
 
     return mem;
 }
 
+template <typename T>
+static T *arena_alloc(GrowingArena *self, size_t amt) {
+    return (T *)arena_alloc_aligned(self, amt, alignof(T));
+}
+
+// Resizes the top allocation without moving it, false when it isn't the top or there is no room left
+inline bool arena_resize_top(GrowingArena *self, void *ptr, size_t old_size, size_t new_size) {
+    if (ptr == NULL || (u8 *)ptr != self->top) return false;
+    // note: a block that crosses the threshold has to move, release tells them apart by size
+    if (arena_is_large(self, new_size)) return false;
+
+    old_size = arena_block_size(self, old_size);
+    new_size = arena_block_size(self, new_size);
+
+    ArenaRegion *region = self->current;
+    size_t start = self->top - region->mem;
+    if (start + new_size > region->size && !arena_region_commit(self, region, start + new_size)) return false;
+
+    region->off = start + new_size;
+    self->used += (i64)new_size - (i64)old_size;
+    if (self->used > self->peak_used) self->peak_used = self->used;
+    if (self->total > self->peak_total) self->peak_total = self->total;
+    return true;
+}
+
+// Gives a block back. Large blocks are unmapped, the top block goes straight back to the region,
+// with recycle on small blocks land in their size class free list, anything else stays dead until the next reset.
+inline void arena_release(GrowingArena *self, void *ptr, size_t size) {
+    if (ptr == NULL) return;
+
+    if (arena_is_large(self, size)) {
+        arena_large_free(self, ((ArenaLarge **)ptr)[-1]);
+        return;
+    }
+
+    size = arena_block_size(self, size);
+
+    if ((u8 *)ptr == self->top) {
+        self->current->off = self->top - self->current->mem;
+        self->top = NULL;
+        self->used -= size;
+        return;
+    }
+
+    i32 cls = self->recycle ? arena_free_class(size) : -1;
+    if (cls >= 0) {
+        memcpy(ptr, &self->free_lists[cls], sizeof(void *));
+        self->free_lists[cls] = ptr;
+    }
+    self->used -= size;
+    self->wasted += size;
+}
+
 template <typename T>
 T *arena_realloc(GrowingArena *self, T *old_ptr, size_t old_size, size_t new_size) {
+    self->realloc_cnt += 1;
+    if (arena_resize_top(self, old_ptr, old_size, new_size)) {
+        self->saved += old_size < new_size ? old_size : new_size;
+        return old_ptr;
+    }
+
     T *new_ptr = arena_alloc<T>(self, new_size);
     assert(new_ptr != NULL && "realloc requiest memory but is null");
-    memcpy(new_ptr, old_ptr, old_size);
+    if (old_ptr != NULL) {
+        memcpy(new_ptr, old_ptr, old_size < new_size ? old_size : new_size);
+        arena_release(self, old_ptr, old_size);
+    }
     return new_ptr;
 }
 
 static void arena_reset(GrowingArena *self) {
-    if (self->current == NULL) return; 
+    if (self->current == NULL) return;
 
     while (self->current->prev != NULL) {
         self->current = self->current->prev;
     }
 
+    i32 keep_regions = self->keep_regions > 0 ? self->keep_regions : ARENA_KEEP_REGIONS;
+    size_t keep_bytes = self->keep_bytes > 0 ? self->keep_bytes : ARENA_KEEP_BYTES;
+    i32 decay_resets = self->decay_resets > 0 ? self->decay_resets : ARENA_DECAY_RESETS;
+
+    // Every region keeps the pages its recent peak needed plus whatever fits in the hot budget. Peaks
+    // older than decay_resets resets fall back to the last cycle, so a single heavy frame only pins its
+    // memory for a while. Regions past the first keep_regions that went unused that long are released.
+    size_t hot = 0;
+    i32 index = 0;
     ArenaRegion *region = self->current;
     while (region != NULL) {
-        region->off = 0; 
-        region = region->next;
+        ArenaRegion *next = region->next;
+        if (region->off >= region->high || self->reset_cnt - region->epoch >= decay_resets) {
+            region->high = region->off;
+            region->epoch = self->reset_cnt;
+        }
+        region->off = 0;
+
+        size_t room = hot < keep_bytes ? keep_bytes - hot : 0;
+        if (index >= keep_regions && region->high == 0 && region->size > room) {
+            region->prev->next = next;
+            if (next != NULL) next->prev = region->prev;
+            self->total -= region->size;
+            self->released += region->size;
+            self->region_cnt -= 1;
+            arena_region_destroy(region);
+        } else {
+            size_t need = region->high > room ? region->high : room;
+            size_t keep = (need + ARENA_VM_COMMIT_STEP - 1) / ARENA_VM_COMMIT_STEP * ARENA_VM_COMMIT_STEP;
+            // note: the address range stays reserved so pointers handed out later are still stable
+            if (region->virt && region->size > keep) {
+                arena_vm_decommit(region->mem + keep, region->size - keep);
+                self->total -= region->size - keep;
+                self->released += region->size - keep;
+                region->size = keep;
+            }
+            hot += region->size;
+            index += 1;
+        }
+        region = next;
+    }
+
+    while (self->large != NULL) {
+        arena_large_free(self, self->large);
     }
 
+    self->top = NULL;
+    self->marks = 0;
+    memset(self->free_lists, 0, sizeof(self->free_lists));
     self->used = 0;
     self->wasted = 0;
+    self->reset_cnt += 1;
+    arena_index_rebuild(self);
+
+    if (self->tags != NULL) {
+        for (i32 i = 0; i < self->tags->count; i += 1) {
+            self->tags->items[i].cycle = 0;
+        }
+    }
+}
+
+struct ArenaMark {
+    ArenaRegion *region;
+    i64 region_id;
+    size_t off;
+    u8 *top;
+    i64 used;
+    i64 large_seq;
+    i64 reset_cnt;
+};
+
+// note: every mark has to be rewound (or the arena reset), tail placement stays off until then
+inline ArenaMark arena_mark(GrowingArena *self) {
+    self->marks += 1;
+    ArenaRegion *region = self->current;
+    return ArenaMark{region, region ? region->id : 0, region ? region->off : 0, self->top, self->used, self->large_seq, self->reset_cnt};
+}
+
+// Drops everything allocated after the mark. Regions past the mark only ever got used after it,
+// so this is O(1) on the virtual backend and O(regions touched since the mark) otherwise.
+// A mark from before an arena_reset or arena_free is a no-op, everything after it is already gone.
+inline void arena_rewind(GrowingArena *self, ArenaMark mark) {
+    if (self->marks > 0) self->marks -= 1;
+
+    if (mark.region == NULL) {
+        arena_reset(self);
+        return;
+    }
+
+    // note: the reset may have released mark.region, so it is only compared, never read, until found
+    if (mark.reset_cnt != self->reset_cnt) return;
+    ArenaRegion *found = self->current;
+    while (found != NULL && (found != mark.region || found->id != mark.region_id)) found = found->prev;
+    if (found == NULL) return;
+
+    while (self->large != NULL && self->large->seq >= mark.large_seq) {
+        arena_large_free(self, self->large);
+    }
+
+    bool moved = self->current != mark.region;
+    for (ArenaRegion *region = self->current; region != mark.region; region = region->prev) {
+        region->off = 0;
+    }
+
+    self->current = mark.region;
+    self->current->off = mark.off;
+    self->top = mark.top;
+    self->used = mark.used;
+    // note: the lists may hold blocks past the mark, dropping them only leaks until the next reset
+    memset(self->free_lists, 0, sizeof(self->free_lists));
+    if (moved) arena_index_rebuild(self);
 }
 
+// Rolls the arena back to where it was when the scope was opened
+struct ArenaScope {
+    GrowingArena *arena;
+    ArenaMark mark;
+
+    ArenaScope(GrowingArena *arena) : arena(arena), mark(arena_mark(arena)) {}
+    ~ArenaScope() { arena_rewind(arena, mark); }
+
+    ArenaScope(const ArenaScope &) = delete;
+    ArenaScope &operator=(const ArenaScope &) = delete;
+};
+
 static void arena_free(GrowingArena *self) {
     if (self->current != NULL) {
-        if (self->current->prev == NULL) {
-            free(self->current->mem);
-            free(self->current);
-        } else {
-            assert(self->current->next == NULL && "Looks like the arena didnt reuse all regions!");
-            while (self->current->prev != NULL) {
-                free(self->current->mem);
-                self->current = self->current->prev;
-                free(self->current->next);
+        // note: empty regions can sit past current, so free from the head
+        while (self->current->prev != NULL) {
+            self->current = self->current->prev;
+        }
+        while (self->current != NULL) {
+            ArenaRegion *next = self->current->next;
+            arena_region_destroy(self->current);
+            self->current = next;
+        }
+    }
+    while (self->large != NULL) {
+        arena_large_free(self, self->large);
+    }
+    free(self->index);
+    self->index = NULL;
+    self->index_cnt = 0;
+    self->index_cap = 0;
+    free(self->tags);
+    self->tags = NULL;
+}
+
+// :snapshot
+// Takes and restores compare this many bytes at a time and only copy the pieces that differ
+#define ARENA_SNAPSHOT_CHUNK 4096
+
+// A saved copy of some memory: a region's used bytes, a large block or a registered blob
+struct ArenaSnapshotSpan {
+    void *owner; // ArenaRegion or ArenaLarge the bytes belong to, NULL for blobs
+    i64 id;      // region id or large seq, the owner pointer alone may have been reused
+    u8 *ptr;
+    size_t size;
+    u8 *copy;
+    size_t cap;
+};
+
+struct ArenaSnapshotSpans {
+    ArenaSnapshotSpan *items;
+    i32 count;
+    i32 cap;
+};
+
+// Whole state checkpoint of an arena plus any plain memory registered with arena_snapshot_watch.
+// Buffers are malloc'd and reused by the next take, so checkpointing every move only copies what changed.
+struct ArenaSnapshot {
+    GrowingArena *arena;
+    ArenaRegion *current; // NULL when taken before the first allocation
+    i64 current_id;
+    u8 *top;
+    void *free_lists[ARENA_FREE_CLASSES];
+    i64 used;
+    i64 wasted;
+    i64 padding;
+    i64 large_seq;
+    ArenaSnapshotSpans regions;
+    ArenaSnapshotSpans larges;
+    ArenaSnapshotSpans blobs;
+    bool taken;
+
+    // Bytes written and skipped by the last take or restore
+    i64 copied;
+    i64 skipped;
+};
+
+inline ArenaSnapshotSpan *arena_snapshot_push(ArenaSnapshotSpans *spans) {
+    if (spans->count == spans->cap) {
+        spans->cap = spans->cap == 0 ? 16 : spans->cap * 2;
+        spans->items = (ArenaSnapshotSpan *)realloc(spans->items, sizeof(ArenaSnapshotSpan) * spans->cap);
+        assert(spans->items != NULL && "Out of memory for the snapshot!");
+        memset(spans->items + spans->count, 0, sizeof(ArenaSnapshotSpan) * (spans->cap - spans->count));
+    }
+    return &spans->items[spans->count++];
+}
+
+// Copies the chunks of src that differ from dst, returns how many bytes were written
+inline size_t arena_snapshot_sync(u8 *dst, const u8 *src, size_t size) {
+    size_t copied = 0;
+    for (size_t at = 0; at < size; at += ARENA_SNAPSHOT_CHUNK) {
+        size_t n = size - at < ARENA_SNAPSHOT_CHUNK ? size - at : ARENA_SNAPSHOT_CHUNK;
+        if (memcmp(dst + at, src + at, n) != 0) {
+            memcpy(dst + at, src + at, n);
+            copied += n;
+        }
+    }
+    return copied;
+}
+
+// Refreshes the saved copy of span from its memory, the old copy is diffed against when it fits
+inline void arena_snapshot_save(ArenaSnapshot *snap, ArenaSnapshotSpan *span, void *owner, i64 id, u8 *ptr, size_t size) {
+    bool same = span->owner == owner && span->id == id && span->ptr == ptr && span->copy != NULL;
+    span->owner = owner;
+    span->id = id;
+    span->ptr = ptr;
+
+    if (size > span->cap) {
+        free(span->copy);
+        span->copy = (u8 *)malloc(size);
+        assert(span->copy != NULL && "Out of memory for the snapshot!");
+        span->cap = size;
+        same = false;
+    }
+
+    if (same) {
+        // Bytes past the old size were never compared against, copy them outright
+        size_t common = span->size < size ? span->size : size;
+        size_t copied = arena_snapshot_sync(span->copy, ptr, common);
+        memcpy(span->copy + common, ptr + common, size - common);
+        copied += size - common;
+        snap->copied += copied;
+        snap->skipped += size - copied;
+    } else {
+        memcpy(span->copy, ptr, size);
+        snap->copied += size;
+    }
+    span->size = size;
+}
+
+// Registers plain memory (globals, level state...) that gets saved and restored with the arena.
+// note: a snapshot taken before this never saw the memory, so it is dropped until the next take
+inline void arena_snapshot_watch(ArenaSnapshot *snap, void *ptr, size_t size) {
+    ArenaSnapshotSpan *span = arena_snapshot_push(&snap->blobs);
+    span->owner = NULL;
+    span->id = 0;
+    span->ptr = (u8 *)ptr;
+    span->size = size;
+    span->copy = (u8 *)malloc(size);
+    assert(span->copy != NULL && "Out of memory for the snapshot!");
+    memcpy(span->copy, ptr, size);
+    span->cap = size;
+    snap->taken = false;
+}
+
+inline void arena_snapshot_take(ArenaSnapshot *snap, GrowingArena *arena) {
+    snap->arena = arena;
+    snap->current = arena->current;
+    snap->current_id = arena->current != NULL ? arena->current->id : 0;
+    snap->top = arena->top;
+    memcpy(snap->free_lists, arena->free_lists, sizeof(snap->free_lists));
+    snap->used = arena->used;
+    snap->wasted = arena->wasted;
+    snap->padding = arena->padding;
+    snap->large_seq = arena->large_seq;
+    snap->copied = 0;
+    snap->skipped = 0;
+
+    ArenaRegion *head = arena->current;
+    while (head != NULL && head->prev != NULL) head = head->prev;
+
+    // Spans line up with the list, so a region that stayed put is diffed against its old copy
+    i32 count = 0;
+    for (ArenaRegion *region = head; region != NULL; region = region->next) {
+        if (region->off == 0) continue;
+        ArenaSnapshotSpan *span = count < snap->regions.count ? &snap->regions.items[count] : arena_snapshot_push(&snap->regions);
+        arena_snapshot_save(snap, span, region, region->id, region->mem, region->off);
+        count += 1;
+    }
+    snap->regions.count = count;
+
+    count = 0;
+    for (ArenaLarge *large = arena->large; large != NULL; large = large->next) {
+        ArenaSnapshotSpan *span = count < snap->larges.count ? &snap->larges.items[count] : arena_snapshot_push(&snap->larges);
+        // note: the header holds list links, only the bytes after it are saved
+        arena_snapshot_save(snap, span, large, large->seq, (u8 *)(large + 1), large->size - sizeof(ArenaLarge));
+        count += 1;
+    }
+    snap->larges.count = count;
+
+    for (i32 i = 0; i < snap->blobs.count; i += 1) {
+        ArenaSnapshotSpan *blob = &snap->blobs.items[i];
+        arena_snapshot_save(snap, blob, NULL, 0, blob->ptr, blob->size);
+    }
+    snap->taken = true;
+}
+
+inline bool arena_snapshot_has_region(GrowingArena *arena, ArenaRegion *target, i64 id) {
+    ArenaRegion *region = arena->current;
+    while (region != NULL && region->prev != NULL) region = region->prev;
+    for (; region != NULL; region = region->next) {
+        if (region == target && region->id == id) return true;
+    }
+    return false;
+}
+
+inline bool arena_snapshot_has_large(GrowingArena *arena, ArenaLarge *target, i64 seq) {
+    for (ArenaLarge *large = arena->large; large != NULL; large = large->next) {
+        if (large == target && large->seq == seq) return true;
+    }
+    return false;
+}
+
+// Puts the arena and the watched memory back the way they were at the last take. Regions and
+// chunks that did not change are skipped. Returns false without touching anything when memory
+// the snapshot refers to has since been given back (arena_free, or a large block released).
+inline bool arena_snapshot_restore(ArenaSnapshot *snap) {
+    if (!snap->taken) return false;
+    GrowingArena *arena = snap->arena;
+
+    if (snap->current != NULL && !arena_snapshot_has_region(arena, snap->current, snap->current_id)) return false;
+    for (i32 i = 0; i < snap->regions.count; i += 1) {
+        ArenaRegion *region = (ArenaRegion *)snap->regions.items[i].owner;
+        if (!arena_snapshot_has_region(arena, region, snap->regions.items[i].id)) return false;
+        // A reset since the take may have decommitted the pages
+        size_t end = snap->regions.items[i].size;
+        if (end > region->size && !arena_region_commit(arena, region, end)) return false;
+    }
+    for (i32 i = 0; i < snap->larges.count; i += 1) {
+        ArenaSnapshotSpan *span = &snap->larges.items[i];
+        if (!arena_snapshot_has_large(arena, (ArenaLarge *)span->owner, span->id)) return false;
+    }
+
+    snap->copied = 0;
+    snap->skipped = 0;
+
+    ArenaLarge *large = arena->large;
+    while (large != NULL) {
+        ArenaLarge *next = large->next;
+        if (large->seq >= snap->large_seq) arena_large_free(arena, large);
+        large = next;
+    }
+
+    // Everything allocated since the take is dropped, saved regions get their bytes back
+    ArenaRegion *head = arena->current;
+    while (head != NULL && head->prev != NULL) head = head->prev;
+    for (ArenaRegion *region = head; region != NULL; region = region->next) {
+        region->off = 0;
+    }
+
+    ArenaSnapshotSpans *lists[] = {&snap->regions, &snap->larges, &snap->blobs};
+    for (ArenaSnapshotSpans *spans : lists) {
+        for (i32 i = 0; i < spans->count; i += 1) {
+            ArenaSnapshotSpan *span = &spans->items[i];
+            if (spans == &snap->regions) {
+                ((ArenaRegion *)span->owner)->off = span->size;
             }
-            free(self->current->mem);
-            free(self->current);
+            size_t copied = arena_snapshot_sync(span->ptr, span->copy, span->size);
+            snap->copied += copied;
+            snap->skipped += span->size - copied;
         }
     }
+
+    // note: regions that were empty at the take may have moved, but never ahead of a used one.
+    // Taken before the first allocation: the regions stay, all empty, like after arena_reset
+    arena->current = snap->current != NULL ? snap->current : head;
+    arena->top = snap->top;
+    memcpy(arena->free_lists, snap->free_lists, sizeof(arena->free_lists));
+    arena->used = snap->used;
+    arena->wasted = snap->wasted;
+    arena->padding = snap->padding;
+    arena_index_rebuild(arena);
+    return true;
+}
+
+inline void arena_snapshot_free(ArenaSnapshot *snap) {
+    ArenaSnapshotSpans *lists[] = {&snap->regions, &snap->larges, &snap->blobs};
+    for (ArenaSnapshotSpans *spans : lists) {
+        for (i32 i = 0; i < spans->cap; i += 1) {
+            free(spans->items[i].copy);
+        }
+        free(spans->items);
+        *spans = ArenaSnapshotSpans{};
+    }
+    snap->taken = false;
+}
+
+// Attributes every allocation made while it is alive to `tag`
+struct ArenaTag {
+    GrowingArena *arena;
+    const char *prev;
+
+    ArenaTag(GrowingArena *arena, const char *tag) : arena(arena), prev(arena->tag) { arena->tag = tag; }
+    ~ArenaTag() { arena->tag = prev; }
+
+    ArenaTag(const ArenaTag &) = delete;
+    ArenaTag &operator=(const ArenaTag &) = delete;
+};
+
+#define ARENA_TAG_CONCAT_(a, b) a##b
+#define ARENA_TAG_CONCAT(a, b) ARENA_TAG_CONCAT_(a, b)
+#define ARENA_TAG(arena, tag) ArenaTag ARENA_TAG_CONCAT(arena_tag_, __LINE__)(arena, tag)
+
+inline void arena_report(GrowingArena *self, const char *name, FILE *out = stdout) {
+    fprintf(out, "arena %s: %d regions\n", name, self->region_cnt);
+    fprintf(out, "    used    %lld (peak %lld)\n", self->used, self->peak_used);
+    fprintf(out, "    total   %lld (peak %lld)\n", self->total, self->peak_total);
+    fprintf(out, "    wasted  %lld, padding %lld, fragmentation %.3f\n", self->wasted, self->padding, arena_fragmentation(self));
+    fprintf(out, "    saved   %lld, reused %lld\n", self->saved, self->reused);
+    fprintf(out, "    allocs  %lld, reallocs %lld, resets %lld\n", self->alloc_cnt, self->realloc_cnt, self->reset_cnt);
+    fprintf(out, "    large   %lld blocks, %lld used, %lld mapped\n", self->large_cnt, self->large_used, self->large_total);
+    fprintf(out, "    released %lld to the os\n", self->released);
+    if (self->tags != NULL) {
+        for (i32 i = 0; i < self->tags->count; i += 1) {
+            ArenaTagStats *tag = &self->tags->items[i];
+            fprintf(out, "    [%s] %lld bytes in %lld allocs, peak %lld per reset\n", tag->name, tag->bytes, tag->count, tag->peak);
+        }
+    }
+}
+
+// note: names and tags are written as is, keep them free of quotes
+inline void arena_report_json(GrowingArena *self, const char *name, FILE *out = stdout) {
+    fprintf(out, "{\"arena\": \"%s\", \"regions\": %d, ", name, self->region_cnt);
+    fprintf(out, "\"used\": %lld, \"peak_used\": %lld, \"total\": %lld, \"peak_total\": %lld, ",
+            self->used, self->peak_used, self->total, self->peak_total);
+    fprintf(out, "\"wasted\": %lld, \"padding\": %lld, \"fragmentation\": %.4f, \"saved\": %lld, \"reused\": %lld, ",
+            self->wasted, self->padding, arena_fragmentation(self), self->saved, self->reused);
+    fprintf(out, "\"allocs\": %lld, \"reallocs\": %lld, \"resets\": %lld, ",
+            self->alloc_cnt, self->realloc_cnt, self->reset_cnt);
+    fprintf(out, "\"large_cnt\": %lld, \"large_used\": %lld, \"large_total\": %lld, \"released\": %lld, \"tags\": [",
+            self->large_cnt, self->large_used, self->large_total, self->released);
+    if (self->tags != NULL) {
+        for (i32 i = 0; i < self->tags->count; i += 1) {
+            ArenaTagStats *tag = &self->tags->items[i];
+            fprintf(out, "%s{\"tag\": \"%s\", \"bytes\": %lld, \"count\": %lld, \"peak\": %lld}",
+                    i == 0 ? "" : ", ", tag->name, tag->bytes, tag->count, tag->peak);
+        }
+    }
+    fprintf(out, "]}\n");
+}
+
+// :threads
+// Every thread gets its own GrowingArena on first use, the registry lets a sync point walk all of them
+struct ThreadArena {
+    GrowingArena arena;
+    ThreadArena *next;
+
+    ThreadArena();
+    ~ThreadArena();
+};
+
+struct ArenaRegistry {
+    std::mutex lock;
+    ThreadArena *head;
+};
+
+inline ArenaRegistry arena_registry{};
+
+inline ThreadArena::ThreadArena() : arena{}, next(NULL) {
+    std::lock_guard<std::mutex> guard(arena_registry.lock);
+    next = arena_registry.head;
+    arena_registry.head = this;
+}
+
+inline ThreadArena::~ThreadArena() {
+    {
+        std::lock_guard<std::mutex> guard(arena_registry.lock);
+        ThreadArena **it = &arena_registry.head;
+        while (*it != this) it = &(*it)->next;
+        *it = next;
+    }
+    arena_free(&arena);
+}
+
+inline GrowingArena *arena_thread_local() {
+    thread_local ThreadArena self;
+    return &self.arena;
+}
+
+// note: fn runs with the registry locked, the owning threads must not be allocating meanwhile
+template <typename F>
+void arena_thread_each(F fn) {
+    std::lock_guard<std::mutex> guard(arena_registry.lock);
+    for (ThreadArena *it = arena_registry.head; it != NULL; it = it->next) {
+        fn(&it->arena);
+    }
+}
+
+#define SHARED_ARENA_CHUNK (64 * 1024)
+
+struct SharedArenaChunk {
+    u8 *mem;
+    size_t size;
+    std::atomic<size_t> off;
+};
+
+// Many threads can allocate at once: the fast path is a CAS bump on the current chunk, only
+// refilling a chunk (or a big allocation) takes the lock and touches the backing arena.
+struct SharedArena {
+    std::atomic<SharedArenaChunk *> chunk;
+    std::mutex lock;
+    GrowingArena backing;
+
+    // Only for information
+    std::atomic<size_t> used;
+};
+
+inline void *arena_alloc_aligned(SharedArena *self, size_t amt, size_t align) {
+    assert(align != 0 && (align & (align - 1)) == 0 && "Alignment must be a power of two!");
+
+    for (;;) {
+        SharedArenaChunk *chunk = self->chunk.load(std::memory_order_acquire);
+        if (chunk != NULL) {
+            size_t off = chunk->off.load(std::memory_order_relaxed);
+            for (;;) {
+                size_t start = off + ((size_t)(-(uintptr_t)(chunk->mem + off)) & (align - 1));
+                if (start + amt > chunk->size) break;
+                if (chunk->off.compare_exchange_weak(off, start + amt, std::memory_order_relaxed)) {
+                    self->used.fetch_add(amt, std::memory_order_relaxed);
+                    return chunk->mem + start;
+                }
+            }
+        }
+
+        std::lock_guard<std::mutex> guard(self->lock);
+        // Somebody else refilled while we waited
+        if (self->chunk.load(std::memory_order_relaxed) != chunk) continue;
+
+        if (amt + align > SHARED_ARENA_CHUNK / 4) {
+            self->used.fetch_add(amt, std::memory_order_relaxed);
+            return arena_alloc_aligned(&self->backing, amt, align);
+        }
+
+        SharedArenaChunk *fresh = new (arena_alloc<SharedArenaChunk>(&self->backing, sizeof(SharedArenaChunk))) SharedArenaChunk;
+        fresh->mem = arena_alloc<u8>(&self->backing, SHARED_ARENA_CHUNK);
+        fresh->size = SHARED_ARENA_CHUNK;
+        fresh->off.store(0, std::memory_order_relaxed);
+        self->chunk.store(fresh, std::memory_order_release);
+    }
+}
+
+template <typename T>
+static T *arena_alloc(SharedArena *self, size_t amt) {
+    return (T *)arena_alloc_aligned(self, amt, alignof(T));
+}
+
+template <typename T>
+T *arena_realloc(SharedArena *self, T *old_ptr, size_t old_size, size_t new_size) {
+    T *new_ptr = arena_alloc<T>(self, new_size);
+    assert(new_ptr != NULL && "realloc requiest memory but is null");
+    if (old_ptr != NULL) {
+        memcpy(new_ptr, old_ptr, old_size < new_size ? old_size : new_size);
+    }
+    return new_ptr;
+}
+
+// note: reset and free are not thread safe, call them once the workers are done
+inline void arena_reset(SharedArena *self) {
+    std::lock_guard<std::mutex> guard(self->lock);
+    arena_reset(&self->backing);
+    self->chunk.store(NULL, std::memory_order_relaxed);
+    self->used.store(0, std::memory_order_relaxed);
+}
+
+inline void arena_free(SharedArena *self) {
+    std::lock_guard<std::mutex> guard(self->lock);
+    arena_free(&self->backing);
+    self->backing = GrowingArena{};
+    self->chunk.store(NULL, std::memory_order_relaxed);
+    self->used.store(0, std::memory_order_relaxed);
 }
 
-template<typename ...Args>
-static u8* arena_snprintf(GrowingArena* arena, size_t buf_size, const char *const format, Args... args) {
+// note: always burns buf_size bytes, str.hpp has arena_sprintf which sizes the block exactly
+template<typename Arena, typename ...Args>
+static u8* arena_snprintf(Arena* arena, size_t buf_size, const char *const format, Args... args) {
     u8* mem = arena_alloc<u8>(arena, buf_size);
     snprintf(mem, buf_size, format, args...);
     return mem;
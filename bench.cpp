@@ -0,0 +1,728 @@
+// Headless allocator benchmarks, one JSON object per line on stdout.
+//     clang++ -std=c++17 -O2 bench.cpp -o build/bench
+//     ./build/bench [filter]
+// note: peak_rss is process wide, run a single bench through the filter to attribute it
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "arena.hpp"
+#include "chunk.hpp"
+#include "da.hpp"
+#include "hm.hpp"
+#include "particles.hpp"
+#include "pool.hpp"
+#include "ring.hpp"
+#include "str.hpp"
+#include "types.hpp"
+
+#if defined(_WIN32)
+struct BenchMemoryCounters {
+    unsigned long cb;
+    unsigned long page_fault_count;
+    size_t peak_working_set_size;
+    size_t working_set_size;
+    size_t quota_peak_paged_pool_usage;
+    size_t quota_paged_pool_usage;
+    size_t quota_peak_non_paged_pool_usage;
+    size_t quota_non_paged_pool_usage;
+    size_t pagefile_usage;
+    size_t peak_pagefile_usage;
+};
+extern "C" {
+    __declspec(dllimport) void *__stdcall GetCurrentProcess(void);
+    __declspec(dllimport) int __stdcall K32GetProcessMemoryInfo(void *process, BenchMemoryCounters *counters, unsigned long cb);
+}
+#else
+#include <sys/resource.h>
+#endif
+
+#define FRAMES 200
+#define FRAME_ALLOCS 2000
+#define PATHS 64
+#define PATH_POINTS 4096
+#define PATH_ROUNDS 20
+#define STRINGS 200000
+#define MIXED_OPS 200000
+#define MIXED_ROUNDS 5
+#define HASH_KEYS (1 << 20)
+#define RING_CAP 1024
+#define RING_OPS (1 << 24)
+#define RING_BATCH 64
+#define SPSC_ITEMS (1 << 22)
+#define PARTICLE_UPDATES (1 << 26)
+#define POOL_LIVE 4096
+#define POOL_OPS (1 << 24)
+#define POOL_ROUNDS 1024
+#define CHUNK_ITEMS (1 << 20)
+#define CHUNK_ROUNDS 16
+
+struct BenchPoint {
+    f32 x, y;
+};
+
+static volatile u64 sink;
+
+static double now_ns() {
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static i64 peak_rss() {
+#if defined(_WIN32)
+    BenchMemoryCounters counters{};
+    counters.cb = sizeof(counters);
+    K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+    return (i64)counters.peak_working_set_size;
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+    return (i64)usage.ru_maxrss;
+#else
+    return (i64)usage.ru_maxrss * 1024;
+#endif
+#endif
+}
+
+// wasted/footprint < 0 are written as null, malloc doesn't tell us. Arenas also get their
+// fragmentation and region count, taken before arena_free.
+static void report(const char *bench, const char *impl, i64 ops, double ns, i64 wasted, i64 footprint, GrowingArena *arena = NULL) {
+    printf("{\"bench\": \"%s\", \"impl\": \"%s\", \"ops\": %lld, \"ns_per_op\": %.3f, ", bench, impl, ops, ns / (double)ops);
+    if (wasted < 0) {
+        printf("\"wasted\": null, ");
+    } else {
+        printf("\"wasted\": %lld, ", wasted);
+    }
+    if (footprint < 0) {
+        printf("\"footprint\": null, ");
+    } else {
+        printf("\"footprint\": %lld, ", footprint);
+    }
+    if (arena != NULL) {
+        printf("\"fragmentation\": %.3f, \"region_cnt\": %d, ", arena_fragmentation(arena), arena->region_cnt);
+    }
+    printf("\"peak_rss\": %lld}\n", peak_rss());
+    fflush(stdout);
+}
+
+static void report_arena(const char *bench, const char *impl, i64 ops, double ns, GrowingArena *arena) {
+    report(bench, impl, ops, ns, arena->wasted + arena->padding, arena->peak_total + arena->large_total, arena);
+}
+
+static const char *backend_name(ArenaBackend backend) {
+    return backend == ARENA_BACKEND_REGIONS ? "arena_regions" : "arena_vm";
+}
+
+static u32 rng_state = 1;
+static u32 rng() {
+    // xorshift32, same sequence for every implementation
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+// :frame_scratch
+// Lots of short lived small blocks, all dropped at the end of the frame
+static void bench_frame_scratch() {
+    static u32 sizes[FRAME_ALLOCS];
+    rng_state = 1;
+    for (auto &size : sizes) size = 8 + rng() % 248;
+
+    for (ArenaBackend backend : {ARENA_BACKEND_VIRTUAL, ARENA_BACKEND_REGIONS}) {
+        GrowingArena arena{};
+        arena.backend = backend;
+        double start = now_ns();
+        for (int frame = 0; frame < FRAMES; frame += 1) {
+            for (u32 size : sizes) {
+                u8 *mem = arena_alloc<u8>(&arena, size);
+                mem[0] = (u8)size;
+                sink += (u64)mem[0];
+            }
+            if (frame != FRAMES - 1) arena_reset(&arena);
+        }
+        double took = now_ns() - start;
+        report_arena("frame_scratch", backend_name(backend), (i64)FRAMES * FRAME_ALLOCS, took, &arena);
+        arena_free(&arena);
+    }
+
+    {
+        static u8 *blocks[FRAME_ALLOCS];
+        double start = now_ns();
+        for (int frame = 0; frame < FRAMES; frame += 1) {
+            for (int i = 0; i < FRAME_ALLOCS; i += 1) {
+                blocks[i] = (u8 *)malloc(sizes[i]);
+                blocks[i][0] = (u8)sizes[i];
+                sink += (u64)blocks[i][0];
+            }
+            for (u8 *block : blocks) free(block);
+        }
+        report("frame_scratch", "malloc", (i64)FRAMES * FRAME_ALLOCS, now_ns() - start, -1, -1);
+    }
+}
+
+// :path_growth
+// Many paths growing point by point at the same time, like Connection::points
+static void bench_path_growth() {
+    i64 ops = (i64)PATHS * PATH_POINTS * PATH_ROUNDS;
+
+    for (ArenaBackend backend : {ARENA_BACKEND_VIRTUAL, ARENA_BACKEND_REGIONS}) {
+        GrowingArena arena{};
+        arena.backend = backend;
+        arena.recycle = true;
+        daa<BenchPoint> paths[PATHS];
+        double start = now_ns();
+        for (int round = 0; round < PATH_ROUNDS; round += 1) {
+            for (auto &path : paths) path = make<BenchPoint>(&arena, 4);
+            for (int i = 0; i < PATH_POINTS; i += 1) {
+                for (auto &path : paths) path.append(BenchPoint{(f32)i, (f32)i});
+            }
+            for (auto &path : paths) sink += (u64)path.count;
+            if (round != PATH_ROUNDS - 1) arena_reset(&arena);
+        }
+        double took = now_ns() - start;
+        report_arena("path_growth", backend_name(backend), ops, took, &arena);
+        arena_free(&arena);
+    }
+
+    {
+        double start = now_ns();
+        for (int round = 0; round < PATH_ROUNDS; round += 1) {
+            std::vector<BenchPoint> paths[PATHS];
+            for (int i = 0; i < PATH_POINTS; i += 1) {
+                for (auto &path : paths) path.push_back(BenchPoint{(f32)i, (f32)i});
+            }
+            for (auto &path : paths) sink += (u64)path.size();
+        }
+        report("path_growth", "std_vector", ops, now_ns() - start, -1, -1);
+    }
+}
+
+// :small_strings
+static void bench_small_strings() {
+    for (ArenaBackend backend : {ARENA_BACKEND_VIRTUAL, ARENA_BACKEND_REGIONS}) {
+        GrowingArena arena{};
+        arena.backend = backend;
+        double start = now_ns();
+        for (int i = 0; i < STRINGS; i += 1) {
+            u8 *text = arena_sprintf(&arena, "item %d of %d", i, STRINGS);
+            sink += (u64)text[0];
+        }
+        double took = now_ns() - start;
+        report_arena("small_strings", backend_name(backend), STRINGS, took, &arena);
+        arena_free(&arena);
+    }
+
+    {
+        GrowingArena arena{};
+        StrIntern strings{&arena};
+        double start = now_ns();
+        for (int i = 0; i < STRINGS; i += 1) {
+            // UI like: a handful of distinct labels requested over and over
+            const char *text = str_internf(&strings, "LEVEL %d", i % 16);
+            sink += (u64)text[0];
+        }
+        double took = now_ns() - start;
+        report_arena("small_strings", "intern", STRINGS, took, &arena);
+        arena_free(&arena);
+    }
+
+    {
+        std::vector<char *> texts;
+        texts.reserve(STRINGS);
+        double start = now_ns();
+        for (int i = 0; i < STRINGS; i += 1) {
+            int n = snprintf(NULL, 0, "item %d of %d", i, STRINGS);
+            char *text = (char *)malloc(n + 1);
+            snprintf(text, n + 1, "item %d of %d", i, STRINGS);
+            texts.push_back(text);
+            sink += (u64)text[0];
+        }
+        for (char *text : texts) free(text);
+        report("small_strings", "malloc", STRINGS, now_ns() - start, -1, -1);
+    }
+
+    {
+        std::vector<std::string> texts;
+        texts.reserve(STRINGS);
+        char buf[64];
+        double start = now_ns();
+        for (int i = 0; i < STRINGS; i += 1) {
+            snprintf(buf, sizeof(buf), "item %d of %d", i, STRINGS);
+            texts.emplace_back(buf);
+            sink += (u64)texts.back()[0];
+        }
+        report("small_strings", "std_string", STRINGS, now_ns() - start, -1, -1);
+    }
+}
+
+// :mixed
+// Mostly small blocks with the odd big one, a quarter of them given back early
+struct MixedOp {
+    u32 size;
+    i32 release; // index of an earlier block to give back, -1 for none
+};
+
+static void bench_mixed() {
+    static MixedOp ops[MIXED_OPS];
+    static bool released[MIXED_OPS];
+    rng_state = 7;
+    memset(released, 0, sizeof(released));
+    for (i32 i = 0; i < MIXED_OPS; i += 1) {
+        ops[i].size = rng() % 100 < 2 ? 64 * 1024 + rng() % (1024 * 1024) : 16 + rng() % 496;
+        ops[i].release = -1;
+        if (i > 0 && rng() % 4 == 0) {
+            i32 victim = (i32)(rng() % i);
+            if (!released[victim]) {
+                released[victim] = true;
+                ops[i].release = victim;
+            }
+        }
+    }
+
+    static u8 *blocks[MIXED_OPS];
+    i64 count = (i64)MIXED_OPS * MIXED_ROUNDS;
+
+    // note: the fit only matters with several regions, next fit is there to show what best fit buys
+    struct {
+        ArenaBackend backend;
+        ArenaFit fit;
+        const char *impl;
+    } configs[] = {
+        {ARENA_BACKEND_VIRTUAL, ARENA_FIT_BEST, "arena_vm_best"},
+        {ARENA_BACKEND_REGIONS, ARENA_FIT_BEST, "arena_regions_best"},
+        {ARENA_BACKEND_REGIONS, ARENA_FIT_NEXT, "arena_regions_next"},
+    };
+
+    for (auto &config : configs) {
+        GrowingArena arena{};
+        arena.backend = config.backend;
+        arena.fit = config.fit;
+        arena.recycle = true;
+        double start = now_ns();
+        for (int round = 0; round < MIXED_ROUNDS; round += 1) {
+            for (i32 i = 0; i < MIXED_OPS; i += 1) {
+                blocks[i] = arena_alloc<u8>(&arena, ops[i].size);
+                blocks[i][0] = (u8)i;
+                if (ops[i].release >= 0) {
+                    sink += (u64)blocks[ops[i].release][0];
+                    arena_release(&arena, blocks[ops[i].release], ops[ops[i].release].size);
+                }
+            }
+            if (round != MIXED_ROUNDS - 1) arena_reset(&arena);
+        }
+        double took = now_ns() - start;
+        report_arena("mixed", config.impl, count, took, &arena);
+        arena_free(&arena);
+    }
+
+    {
+        double start = now_ns();
+        for (int round = 0; round < MIXED_ROUNDS; round += 1) {
+            for (i32 i = 0; i < MIXED_OPS; i += 1) {
+                blocks[i] = (u8 *)malloc(ops[i].size);
+                blocks[i][0] = (u8)i;
+                if (ops[i].release >= 0) {
+                    sink += (u64)blocks[ops[i].release][0];
+                    free(blocks[ops[i].release]);
+                }
+            }
+            for (i32 i = 0; i < MIXED_OPS; i += 1) {
+                if (!released[i]) free(blocks[i]);
+            }
+        }
+        report("mixed", "malloc", count, now_ns() - start, -1, -1);
+    }
+}
+
+// :hash
+static void bench_hash() {
+    static u64 keys[HASH_KEYS];
+    static u64 misses[HASH_KEYS];
+    rng_state = 11;
+    for (i32 i = 0; i < HASH_KEYS; i += 1) {
+        keys[i] = ((u64)rng() << 32 | rng()) | 1;
+        misses[i] = ((u64)rng() << 32 | rng()) & ~1ull;
+    }
+
+    for (bool reserved : {false, true}) {
+        const char *impl = reserved ? "hma_reserved" : "hma";
+        GrowingArena arena{};
+        arena.recycle = true;
+        auto map = make_map<u64, u64>(&arena, reserved ? HASH_KEYS : 0);
+
+        double start = now_ns();
+        for (u64 key : keys) map.put(key, key);
+        report_arena("hash_insert", impl, HASH_KEYS, now_ns() - start, &arena);
+
+        start = now_ns();
+        for (u64 key : keys) sink += *map.get(key);
+        report_arena("hash_lookup_hit", impl, HASH_KEYS, now_ns() - start, &arena);
+
+        start = now_ns();
+        for (u64 key : misses) sink += map.get(key) != NULL;
+        report_arena("hash_lookup_miss", impl, HASH_KEYS, now_ns() - start, &arena);
+
+        start = now_ns();
+        for (i32 i = 0; i < HASH_KEYS; i += 2) map.erase(keys[i]);
+        report_arena("hash_erase", impl, HASH_KEYS / 2, now_ns() - start, &arena);
+
+        arena_free(&arena);
+    }
+
+    for (bool reserved : {false, true}) {
+        const char *impl = reserved ? "std_unordered_map_reserved" : "std_unordered_map";
+        std::unordered_map<u64, u64> map;
+        if (reserved) map.reserve(HASH_KEYS);
+
+        double start = now_ns();
+        for (u64 key : keys) map[key] = key;
+        report("hash_insert", impl, HASH_KEYS, now_ns() - start, -1, -1);
+
+        start = now_ns();
+        for (u64 key : keys) sink += map.find(key)->second;
+        report("hash_lookup_hit", impl, HASH_KEYS, now_ns() - start, -1, -1);
+
+        start = now_ns();
+        for (u64 key : misses) sink += map.find(key) != map.end();
+        report("hash_lookup_miss", impl, HASH_KEYS, now_ns() - start, -1, -1);
+
+        start = now_ns();
+        for (i32 i = 0; i < HASH_KEYS; i += 2) map.erase(keys[i]);
+        report("hash_erase", impl, HASH_KEYS / 2, now_ns() - start, -1, -1);
+    }
+}
+
+// :ring
+// Bursts of pushes drained right after (event queues), then pushing into a full ring (frame history)
+static void bench_ring() {
+    for (RingPolicy policy : {RING_REJECT, RING_OVERWRITE}) {
+        GrowingArena arena{};
+        auto queue = make_ring<u64>(&arena, RING_CAP, policy);
+        double start = now_ns();
+        for (u64 i = 0; i < RING_OPS; i += RING_BATCH) {
+            for (u64 j = 0; j < RING_BATCH; j += 1) queue.push(i + j);
+            u64 item;
+            while (queue.pop(&item)) sink += item;
+        }
+        report_arena("ring_burst", policy == RING_REJECT ? "ring_reject" : "ring_overwrite", RING_OPS, now_ns() - start, &arena);
+
+        start = now_ns();
+        for (u64 i = 0; i < RING_OPS; i += 1) queue.push(i);
+        sink += queue.back();
+        report_arena("ring_full", policy == RING_REJECT ? "ring_reject" : "ring_overwrite", RING_OPS, now_ns() - start, &arena);
+        arena_free(&arena);
+    }
+
+    {
+        std::deque<u64> queue;
+        double start = now_ns();
+        for (u64 i = 0; i < RING_OPS; i += RING_BATCH) {
+            for (u64 j = 0; j < RING_BATCH; j += 1) queue.push_back(i + j);
+            while (!queue.empty()) {
+                sink += queue.front();
+                queue.pop_front();
+            }
+        }
+        report("ring_burst", "std_deque", RING_OPS, now_ns() - start, -1, -1);
+
+        start = now_ns();
+        for (u64 i = 0; i < RING_OPS; i += 1) {
+            if (queue.size() == RING_CAP) queue.pop_front();
+            queue.push_back(i);
+        }
+        sink += queue.back();
+        report("ring_full", "std_deque", RING_OPS, now_ns() - start, -1, -1);
+    }
+}
+
+// One producer thread handing items to one consumer thread, ns per item moved.
+// note: waiting sides yield, spinning would starve the other thread on a single core
+static void bench_spsc() {
+    {
+        GrowingArena arena{};
+        static spsc<u64> queue;
+        spsc_init(&queue, &arena, RING_CAP);
+
+        double start = now_ns();
+        std::thread producer([] {
+            for (u64 i = 0; i < SPSC_ITEMS; i += 1) {
+                while (!queue.push(i)) std::this_thread::yield();
+            }
+        });
+        u64 sum = 0;
+        for (u64 i = 0; i < SPSC_ITEMS; i += 1) {
+            u64 item;
+            while (!queue.pop(&item)) std::this_thread::yield();
+            sum += item;
+        }
+        producer.join();
+        sink += sum;
+        report_arena("spsc", "spsc", SPSC_ITEMS, now_ns() - start, &arena);
+        arena_free(&arena);
+    }
+
+    {
+        static std::mutex lock;
+        static std::deque<u64> queue;
+
+        double start = now_ns();
+        std::thread producer([] {
+            for (u64 i = 0; i < SPSC_ITEMS; i += 1) {
+                std::lock_guard<std::mutex> guard(lock);
+                queue.push_back(i);
+            }
+        });
+        u64 sum = 0;
+        for (u64 i = 0; i < SPSC_ITEMS;) {
+            std::lock_guard<std::mutex> guard(lock);
+            while (!queue.empty()) {
+                sum += queue.front();
+                queue.pop_front();
+                i += 1;
+            }
+        }
+        producer.join();
+        sink += sum;
+        report("spsc", "mutex_deque", SPSC_ITEMS, now_ns() - start, -1, -1);
+    }
+}
+
+// :particles
+// The game's PATH update as it was before the SoA kernel, kept as the reference
+struct BenchParticle {
+    BenchPoint pos, vel, dir, size;
+    f32 t;
+};
+
+static void bench_particles() {
+    // note: dir comes out of Vector2Negate in the game, so -0 shows up and has to count as 0
+    static const BenchPoint dirs[] = {{1, 0}, {-1, -0.0f}, {0, 1}, {-0.0f, -1}};
+    const f32 dt = 1.0f / 60.0f;
+
+    for (i32 count : {1000, 100000, 1000000}) {
+        i32 steps = PARTICLE_UPDATES / count;
+        i64 ops = (i64)count * steps;
+
+        GrowingArena arena{};
+        BenchParticle *aos = arena_alloc<BenchParticle>(&arena, sizeof(BenchParticle) * count);
+        ParticleSoa soa = make_particles(&arena, count);
+        ParticleSoa scalar = make_particles(&arena, count);
+        rng_state = 5;
+        for (i32 i = 0; i < count; i += 1) {
+            BenchPoint vel = {(f32)((i32)(rng() % 201) - 100), (f32)((i32)(rng() % 201) - 100)};
+            BenchPoint dir = dirs[rng() % 4];
+            aos[i] = BenchParticle{{0, 0}, vel, dir, {8, 8}, 0};
+            soa.append(0, 0, vel.x, vel.y, dir.x, dir.y, 0, 0);
+            scalar.append(0, 0, vel.x, vel.y, dir.x, dir.y, 0, 0);
+        }
+
+        char impl[32];
+        double start = now_ns();
+        for (i32 step = 0; step < steps; step += 1) {
+            for (i32 i = 0; i < count; i += 1) {
+                BenchParticle &p = aos[i];
+                if (p.dir.y != 0) {
+                    p.pos.x += (p.vel.x * dt);
+                    p.pos.y += (p.vel.y * p.dir.y * dt);
+                } else {
+                    p.pos.x += (p.vel.x * p.dir.x * dt);
+                    p.pos.y += (p.vel.y * dt);
+                }
+                p.t += dt;
+                p.size.x = 8 * (p.t / 0.6);
+            }
+        }
+        snprintf(impl, sizeof(impl), "aos_branchy_%d", count);
+        report("particles", impl, ops, now_ns() - start, -1, -1);
+
+        start = now_ns();
+        for (i32 step = 0; step < steps; step += 1) particles_integrate_scalar(&scalar, 0, scalar.count, dt);
+        snprintf(impl, sizeof(impl), "soa_scalar_%d", count);
+        report("particles", impl, ops, now_ns() - start, -1, -1);
+
+        start = now_ns();
+        for (i32 step = 0; step < steps; step += 1) particles_integrate(&soa, dt);
+        snprintf(impl, sizeof(impl), "soa_%s_%d", particles_simd_name(), count);
+        report("particles", impl, ops, now_ns() - start, -1, -1);
+
+        i32 mismatches = 0;
+        for (i32 i = 0; i < count; i += 1) {
+            f32 x = soa.field<PARTICLE_POS_X>()[i], y = soa.field<PARTICLE_POS_Y>()[i];
+            f32 sx = scalar.field<PARTICLE_POS_X>()[i], sy = scalar.field<PARTICLE_POS_Y>()[i];
+            if (memcmp(&x, &aos[i].pos.x, 4) != 0 || memcmp(&y, &aos[i].pos.y, 4) != 0 ||
+                memcmp(&sx, &aos[i].pos.x, 4) != 0 || memcmp(&sy, &aos[i].pos.y, 4) != 0) {
+                mismatches += 1;
+            }
+        }
+        if (mismatches != 0) fprintf(stderr, "particles: %d of %d differ from the reference\n", mismatches, count);
+        arena_free(&arena);
+    }
+}
+
+// :pool
+// A steady live count with constant turnover, like particles: every op despawns a random live
+// object and spawns a new one in its place, then passes over the live objects
+struct BenchObject {
+    BenchPoint pos, vel;
+    f32 t;
+};
+
+static void bench_pool() {
+    static Handle handles[POOL_LIVE];
+    static BenchObject *objects[POOL_LIVE];
+    i64 walked = (i64)POOL_LIVE * POOL_ROUNDS;
+
+    {
+        GrowingArena arena{};
+        auto objs = make_pool<BenchObject>(&arena);
+        for (i32 i = 0; i < POOL_LIVE; i += 1) handles[i] = objs.spawn(BenchObject{{(f32)i, 0}, {1, 1}, 0});
+        i64 allocs = arena.alloc_cnt + arena.realloc_cnt;
+
+        rng_state = 13;
+        double start = now_ns();
+        for (i32 i = 0; i < POOL_OPS; i += 1) {
+            u32 at = rng() % POOL_LIVE;
+            objs.despawn(handles[at]);
+            handles[at] = objs.spawn(BenchObject{{(f32)i, 0}, {1, 1}, 0});
+        }
+        report_arena("pool_churn", "pool", POOL_OPS, now_ns() - start, &arena);
+
+        start = now_ns();
+        for (i32 round = 0; round < POOL_ROUNDS; round += 1) {
+            for (BenchObject &obj : objs) {
+                obj.pos.x += obj.vel.x;
+                obj.t += 1;
+            }
+        }
+        sink += (u64)objs.items[0].t;
+        report_arena("pool_walk", "pool", walked, now_ns() - start, &arena);
+
+        i32 dead = 0;
+        for (Handle h : handles) dead += objs.alive(h) ? 0 : 1;
+        if (dead != 0 || objs.len() != POOL_LIVE) fprintf(stderr, "pool: %d live handles went stale\n", dead);
+        if (arena.alloc_cnt + arena.realloc_cnt != allocs) fprintf(stderr, "pool: churning allocated\n");
+        arena_free(&arena);
+    }
+
+    {
+        rng_state = 13;
+        for (i32 i = 0; i < POOL_LIVE; i += 1) objects[i] = new BenchObject{{(f32)i, 0}, {1, 1}, 0};
+        double start = now_ns();
+        for (i32 i = 0; i < POOL_OPS; i += 1) {
+            u32 at = rng() % POOL_LIVE;
+            delete objects[at];
+            objects[at] = new BenchObject{{(f32)i, 0}, {1, 1}, 0};
+        }
+        report("pool_churn", "new_delete", POOL_OPS, now_ns() - start, -1, -1);
+
+        start = now_ns();
+        for (i32 round = 0; round < POOL_ROUNDS; round += 1) {
+            for (BenchObject *obj : objects) {
+                obj->pos.x += obj->vel.x;
+                obj->t += 1;
+            }
+        }
+        sink += (u64)objects[0]->t;
+        report("pool_walk", "new_delete", walked, now_ns() - start, -1, -1);
+        for (BenchObject *obj : objects) delete obj;
+    }
+}
+
+// :chunk
+// Filling a list one item at a time and walking it, chunk_array pays for its stable addresses
+// with a split index on every access unless it is walked chunk by chunk
+static void bench_chunk() {
+    i64 ops = (i64)CHUNK_ITEMS * CHUNK_ROUNDS;
+
+    {
+        GrowingArena arena{};
+        auto items = make_chunked<BenchPoint>(&arena);
+        BenchPoint *first = NULL;
+        double start = now_ns();
+        for (i32 round = 0; round < CHUNK_ROUNDS; round += 1) {
+            items.clear();
+            for (i32 i = 0; i < CHUNK_ITEMS; i += 1) {
+                BenchPoint *at = items.append(BenchPoint{(f32)i, (f32)round});
+                if (i == 0 && first == NULL) first = at;
+            }
+        }
+        report_arena("chunk_append", "chunk_array", ops, now_ns() - start, &arena);
+        if (first != &items[0]) fprintf(stderr, "chunk: the first item moved\n");
+
+        f32 sum = 0;
+        start = now_ns();
+        for (i32 round = 0; round < CHUNK_ROUNDS; round += 1) {
+            for (i32 i = 0; i < items.count; i += 1) sum += items[i].x;
+        }
+        report("chunk_walk", "chunk_array_index", ops, now_ns() - start, -1, -1);
+
+        start = now_ns();
+        for (i32 round = 0; round < CHUNK_ROUNDS; round += 1) {
+            for (i32 c = 0; c < items.used_chunks(); c += 1) {
+                for (BenchPoint &p : items.chunk(c)) sum += p.x;
+            }
+        }
+        report("chunk_walk", "chunk_array_chunks", ops, now_ns() - start, -1, -1);
+        sink += (u64)sum;
+        arena_free(&arena);
+    }
+
+    {
+        GrowingArena arena{};
+        auto items = make<BenchPoint>(&arena, 0);
+        double start = now_ns();
+        for (i32 round = 0; round < CHUNK_ROUNDS; round += 1) {
+            items.clear();
+            for (i32 i = 0; i < CHUNK_ITEMS; i += 1) items.append(BenchPoint{(f32)i, (f32)round});
+        }
+        report_arena("chunk_append", "daa", ops, now_ns() - start, &arena);
+
+        f32 sum = 0;
+        start = now_ns();
+        for (i32 round = 0; round < CHUNK_ROUNDS; round += 1) {
+            for (BenchPoint &p : items) sum += p.x;
+        }
+        report("chunk_walk", "daa", ops, now_ns() - start, -1, -1);
+        sink += (u64)sum;
+        arena_free(&arena);
+    }
+}
+
+struct Bench {
+    const char *name;
+    void (*run)();
+};
+
+static Bench benches[] = {
+    {"frame_scratch", bench_frame_scratch},
+    {"path_growth", bench_path_growth},
+    {"small_strings", bench_small_strings},
+    {"mixed", bench_mixed},
+    {"hash", bench_hash},
+    {"ring_buffer", bench_ring},
+    {"spsc", bench_spsc},
+    {"particles", bench_particles},
+    {"pool", bench_pool},
+    {"chunk", bench_chunk},
+};
+
+int main(int argc, char **argv) {
+    const char *filter = argc > 1 ? argv[1] : NULL;
+
+    for (auto &bench : benches) {
+        if (filter != NULL && strstr(bench.name, filter) == NULL) continue;
+        bench.run();
+    }
+
+    return sink == 42 ? 1 : 0;
+}
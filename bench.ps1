@@ -0,0 +1,23 @@
+mkdir -Force .\build > $null
+
+$CPP_FLAGS = "-std=c++17 -O2"
+
+$clang_cmd = @(
+	"clang++",
+	$CPP_FLAGS,
+	"-o ./build/bench.exe",
+	"bench.cpp"
+);
+
+$cmd = $($clang_cmd -join ' ');
+
+Write-Host "Exec: $cmd"
+
+Invoke-Expression $cmd
+
+if ( $LastExitCode -ne 0) {
+	Write-Host "Failed compilation..." -ForegroundColor Red
+	exit 1
+}
+
+& ./build/bench.exe $args
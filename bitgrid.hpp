@@ -0,0 +1,182 @@
+#pragma once
+
+#include "types.hpp"
+#include <cassert>
+#include <cstring>
+
+// One bit per cell, row major: cell (x, y) is bit y * W + x. Bits past W * H are always zero,
+// so counts and comparisons can work on whole words.
+template <i32 W, i32 H>
+struct bitgrid {
+    static constexpr i32 cells = W * H;
+    static constexpr i32 words = (cells + 63) / 64;
+
+    u64 bits[words];
+
+    static i32 index(i32 x, i32 y) {
+        assert(x >= 0 && x < W && y >= 0 && y < H);
+        return y * W + x;
+    }
+
+    bool get(i32 i) const {
+        return (bits[i >> 6] >> (i & 63)) & 1;
+    }
+
+    bool get(i32 x, i32 y) const {
+        return get(index(x, y));
+    }
+
+    void set(i32 i) {
+        bits[i >> 6] |= 1ull << (i & 63);
+    }
+
+    void set(i32 x, i32 y) {
+        set(index(x, y));
+    }
+
+    void unset(i32 i) {
+        bits[i >> 6] &= ~(1ull << (i & 63));
+    }
+
+    void unset(i32 x, i32 y) {
+        unset(index(x, y));
+    }
+
+    void clear() {
+        memset(bits, 0, sizeof(bits));
+    }
+
+    // Zeroes the bits past the last cell, ops that can set them call it
+    void trim() {
+        if (cells % 64 != 0) bits[words - 1] &= (1ull << (cells % 64)) - 1;
+    }
+
+    i32 count() const {
+        i32 n = 0;
+        for (i32 i = 0; i < words; i += 1) n += __builtin_popcountll(bits[i]);
+        return n;
+    }
+
+    bool any() const {
+        for (i32 i = 0; i < words; i += 1) {
+            if (bits[i] != 0) return true;
+        }
+        return false;
+    }
+
+    bool full() const {
+        return count() == cells;
+    }
+
+    bool operator==(const bitgrid &other) const {
+        return memcmp(bits, other.bits, sizeof(bits)) == 0;
+    }
+
+    bitgrid &operator&=(const bitgrid &other) {
+        for (i32 i = 0; i < words; i += 1) bits[i] &= other.bits[i];
+        return *this;
+    }
+
+    bitgrid &operator|=(const bitgrid &other) {
+        for (i32 i = 0; i < words; i += 1) bits[i] |= other.bits[i];
+        return *this;
+    }
+
+    // Clears every cell that is set in other
+    bitgrid &andnot(const bitgrid &other) {
+        for (i32 i = 0; i < words; i += 1) bits[i] &= ~other.bits[i];
+        return *this;
+    }
+
+    bitgrid operator~() const {
+        bitgrid out;
+        for (i32 i = 0; i < words; i += 1) out.bits[i] = ~bits[i];
+        out.trim();
+        return out;
+    }
+
+    // Moves every cell n bits towards the end (n > 0) or the start (n < 0) of the grid
+    bitgrid shifted(i32 n) const {
+        bitgrid out{};
+        i32 move = n < 0 ? -n : n;
+        i32 ws = move >> 6, bs = move & 63;
+        for (i32 i = 0; i < words; i += 1) {
+            i32 from = n > 0 ? i - ws : i + ws;
+            if (from < 0 || from >= words) continue;
+            u64 word = bits[from];
+            if (n > 0) {
+                out.bits[i] |= word << bs;
+                if (bs != 0 && i + 1 < words) out.bits[i + 1] |= word >> (64 - bs);
+            } else {
+                out.bits[i] |= word >> bs;
+                if (bs != 0 && i > 0) out.bits[i - 1] |= word << (64 - bs);
+            }
+        }
+        out.trim();
+        return out;
+    }
+
+    static bitgrid column(i32 x) {
+        bitgrid out{};
+        for (i32 y = 0; y < H; y += 1) out.set(x, y);
+        return out;
+    }
+
+    // Neighbour masks: each cell of the result is set when the cell next to it in that direction is
+    bitgrid from_west() const {
+        static const bitgrid first = column(0);
+        return shifted(1).andnot(first);
+    }
+
+    bitgrid from_east() const {
+        static const bitgrid last = column(W - 1);
+        return shifted(-1).andnot(last);
+    }
+
+    bitgrid from_north() const {
+        return shifted(W);
+    }
+
+    bitgrid from_south() const {
+        return shifted(-W);
+    }
+
+    // Cells with at least one set orthogonal neighbour
+    bitgrid neighbours() const {
+        bitgrid out = from_west();
+        out |= from_east();
+        out |= from_north();
+        out |= from_south();
+        return out;
+    }
+
+    // Every cell of `open` connected to the seed cells through other cells of `open`
+    static bitgrid reach(bitgrid seed, const bitgrid &open) {
+        seed &= open;
+        for (;;) {
+            bitgrid next = seed.neighbours();
+            next &= open;
+            next |= seed;
+            if (next == seed) return seed;
+            seed = next;
+        }
+    }
+
+    // Lowest set cell at or after `from`, -1 when there is none:
+    //     for (i32 i = grid.next(0); i >= 0; i = grid.next(i + 1))
+    i32 next(i32 from) const {
+        if (from >= cells) return -1;
+        i32 w = from >> 6;
+        u64 word = bits[w] & (~0ull << (from & 63));
+        for (;;) {
+            if (word != 0) return w * 64 + __builtin_ctzll(word);
+            w += 1;
+            if (w == words) return -1;
+            word = bits[w];
+        }
+    }
+
+    i32 first() const {
+        return next(0);
+    }
+};
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "arena.hpp"
+#include "da.hpp"
+#include "types.hpp"
+#include <cassert>
+
+// Items per chunk when not given, a power of two so indexing is a shift and a mask
+#define CHUNK_DEFAULT_ITEMS 64
+
+// Growable array whose items never move: it grows a chunk at a time and only the table of
+// chunk pointers gets reallocated, so pointers into it stay valid until clear() or an arena rewind.
+template <typename T, i32 N = CHUNK_DEFAULT_ITEMS>
+struct chunk_array {
+    static_assert(N > 0 && (N & (N - 1)) == 0, "chunk size has to be a power of two");
+
+    T **chunks;
+    i32 chunk_cnt; // chunks allocated, they are kept across clear()
+    i32 chunk_cap;
+    i32 count;
+    GrowingArena *arena;
+
+    // Returns where the item lives, the pointer stays valid while the array grows
+    T *append(const T &item) {
+        if (count == chunk_cnt * N) {
+            if (chunk_cnt == chunk_cap) {
+                i32 new_cap = chunk_cap == 0 ? 8 : chunk_cap * 2;
+                chunks = arena_realloc<T *>(arena, chunks, sizeof(T *) * chunk_cap, sizeof(T *) * new_cap);
+                assert(chunks != NULL && "Memory isnt valid anymore!");
+                chunk_cap = new_cap;
+            }
+            chunks[chunk_cnt] = arena_alloc<T>(arena, sizeof(T) * N);
+            assert(chunks[chunk_cnt] != NULL && "Arena allocator failed!");
+            chunk_cnt += 1;
+        }
+
+        T *at = &chunks[count / N][count % N];
+        *at = item;
+        count += 1;
+        return at;
+    }
+
+    T pop() {
+        count -= 1;
+        return (*this)[count];
+    }
+
+    T &operator[](int index) const {
+        assert(index >= 0 && index < count);
+        return chunks[index / N][index % N];
+    }
+
+    T &last() const {
+        return (*this)[count - 1];
+    }
+
+    int len() const {
+        return count;
+    }
+
+    void clear() {
+        count = 0;
+    }
+
+    // Chunks holding items, walk them with chunk(c) to get contiguous runs
+    i32 used_chunks() const {
+        return (count + N - 1) / N;
+    }
+
+    span<T> chunk(i32 c) const {
+        assert(c >= 0 && c < used_chunks());
+        i32 n = count - c * N;
+        return span<T>{chunks[c], n < N ? n : N};
+    }
+
+    struct iterator {
+        const chunk_array *array;
+        i32 at;
+
+        T &operator*() const { return (*array)[at]; }
+        T *operator->() const { return &(*array)[at]; }
+
+        iterator &operator++() {
+            at += 1;
+            return *this;
+        }
+
+        bool operator!=(const iterator &other) const { return at != other.at; }
+    };
+
+    iterator begin() const {
+        return iterator{this, 0};
+    }
+
+    iterator end() const {
+        return iterator{this, count};
+    }
+};
+
+template <typename T, i32 N = CHUNK_DEFAULT_ITEMS>
+static chunk_array<T, N> make_chunked(GrowingArena *arena) {
+    return chunk_array<T, N>{NULL, 0, 0, 0, arena};
+}
@@ -4,8 +4,54 @@
 #include "types.hpp"
 #include <cassert>
 #include <cstdio>
+#include <cstring>
+#include <type_traits>
 
 #define INITIAL_CAP 1024
+// Smallest block a daa grows into when it has no capacity at all
+#define DAA_MIN_CAP 16
+
+// How a full daa picks its next capacity, zeroed means doubling
+struct DaaGrowth {
+    f32 factor;   // cap * factor, 0 means 2
+    i32 max_step; // never add more than this many items at once, 0 means no limit
+    bool exact;   // grow to exactly what was asked for
+};
+
+inline i32 daa_next_cap(DaaGrowth growth, i32 cap, i32 need) {
+    if (growth.exact) return need;
+    if (cap == 0) return need > DAA_MIN_CAP ? need : DAA_MIN_CAP;
+
+    f32 factor = growth.factor > 1 ? growth.factor : 2;
+    i32 new_cap = (i32)(cap * factor);
+    if (new_cap <= cap) new_cap = cap + 1;
+    if (growth.max_step > 0 && new_cap - cap > growth.max_step) new_cap = cap + growth.max_step;
+    return new_cap > need ? new_cap : need;
+}
+
+// Non-owning view of count items, stays valid until the owner grows or the arena rewinds
+template<typename T>
+struct span {
+    T* items;
+    i32 count;
+
+    T &operator[](int index) const {
+        assert(index >= 0 && index < count);
+        return items[index];
+    }
+
+    int len() const {
+        return count;
+    }
+
+    T *begin() const {
+        return items;
+    }
+
+    T *end() const {
+        return items + count;
+    }
+};
 
 template<typename T>
 struct daa {
@@ -13,23 +59,15 @@ struct daa {
     i32 cap;
     i32 count;    
     GrowingArena* arena;
+    DaaGrowth growth;
 
+    // note: nothing is allocated until the first append, cap is only what that one will ask for
     void append(T item) {
-        if (items == NULL) {
-            items = arena_alloc<T>(arena, sizeof(T) * cap);
-        }
-
-        if (count >= cap) {
-            i32 new_cap = cap * 2;
-            items = arena_realloc<T>(arena, items, sizeof(T) * cap, sizeof(T) * new_cap);
-            assert(items != NULL && "Memory isnt valid anymore!");
-            cap = new_cap;
-            
-        }
+        if (items == NULL || count >= cap) reserve(count + 1);
         items[count] = item;
         count += 1;
     }
-	
+
 	T pop() {
 		return items[--count];
 	}
@@ -46,7 +84,11 @@ struct daa {
       count = 0;
   }
 
-  T operator[](int index) const {
+  T &operator[](int index) {
+      return items[index];
+  }
+
+  const T &operator[](int index) const {
       return items[index];
   }
 
@@ -54,14 +96,208 @@ struct daa {
       return count;
   }
 
-  T last() const {
+  T &last() {
+      return items[count - 1];
+  }
+
+  const T &last() const {
       return items[count - 1];
   }
+
+  T *begin() const {
+      return items;
+  }
+
+  T *end() const {
+      return items + count;
+  }
+
+  span<T> view() const {
+      return span<T>{items, count};
+  }
+
+  span<T> view(i32 from, i32 n) const {
+      assert(from >= 0 && n >= 0 && from + n <= count);
+      return span<T>{items + from, n};
+  }
+
+  // Room for at least n items, the growth policy picks how many more
+  void reserve(i32 n) {
+      if (n <= 0 || (items != NULL && n <= cap)) return;
+
+      i32 new_cap = items == NULL && n <= cap ? cap : daa_next_cap(growth, cap, n);
+      items = arena_realloc<T>(arena, items, items != NULL ? sizeof(T) * cap : 0, sizeof(T) * new_cap);
+      assert(items != NULL && "Memory isnt valid anymore!");
+      cap = new_cap;
+  }
+
+  // Gives the unused capacity back, in place when the items are the arena top
+  void shrink_to_fit() {
+      if (items == NULL || count == cap) return;
+
+      if (count == 0) {
+          arena_release(arena, items, sizeof(T) * cap);
+          items = NULL;
+          cap = 0;
+          return;
+      }
+      items = arena_realloc<T>(arena, items, sizeof(T) * cap, sizeof(T) * count);
+      cap = count;
+  }
+
+  // note: src must not point into this array, growing may move it
+  void append_n(const T *src, i32 n) {
+      static_assert(std::is_trivially_copyable<T>::value, "daa moves items with memcpy");
+      reserve(count + n);
+      memcpy(items + count, src, sizeof(T) * n);
+      count += n;
+  }
+
+  void insert_n(i32 at, const T *src, i32 n) {
+      static_assert(std::is_trivially_copyable<T>::value, "daa moves items with memcpy");
+      assert(at >= 0 && at <= count);
+      reserve(count + n);
+      memmove(items + at + n, items + at, sizeof(T) * (count - at));
+      memcpy(items + at, src, sizeof(T) * n);
+      count += n;
+  }
+
+  // Removes n items starting at `at`, the ones after it keep their order
+  void erase(i32 at, i32 n = 1) {
+      static_assert(std::is_trivially_copyable<T>::value, "daa moves items with memcpy");
+      assert(at >= 0 && n >= 0 && at + n <= count);
+      memmove(items + at, items + at + n, sizeof(T) * (count - at - n));
+      count -= n;
+  }
+
+  // Drops everything from index n on
+  void truncate(i32 n) {
+      assert(n >= 0);
+      if (n < count) count = n;
+  }
 };
 
 template <typename T>
-static daa<T> make(GrowingArena* arena, i32 initial_cap = INITIAL_CAP) {
-    T* items = arena_alloc<T>(arena, sizeof(T) * initial_cap);
-    assert(items != NULL && "Arena allocator failed!");
-    return daa<T>{items, initial_cap, 0, arena};
+static daa<T> make(GrowingArena* arena, i32 initial_cap = INITIAL_CAP, DaaGrowth growth = {}) {
+    return daa<T>{NULL, initial_cap, 0, arena, growth};
+}
+
+// Keeps up to N items inline and only spills to the arena past that. Stays trivially copyable
+// (no pointer into itself), copies share the spilled buffer like daa copies do.
+template<typename T, i32 N>
+struct small_daa {
+    T* heap; // NULL while the items fit inline
+    i32 cap;
+    i32 count;
+    GrowingArena* arena;
+    T inline_items[N];
+
+    T *data() {
+        return heap != NULL ? heap : inline_items;
+    }
+
+    const T *data() const {
+        return heap != NULL ? heap : inline_items;
+    }
+
+    void reserve(i32 n) {
+        if (n <= (heap != NULL ? cap : N)) return;
+
+        i32 new_cap = heap != NULL ? cap : N;
+        while (new_cap < n) new_cap *= 2;
+        if (heap == NULL) {
+            heap = arena_alloc<T>(arena, sizeof(T) * new_cap);
+            memcpy(heap, inline_items, sizeof(T) * count);
+        } else {
+            heap = arena_realloc<T>(arena, heap, sizeof(T) * cap, sizeof(T) * new_cap);
+        }
+        assert(heap != NULL && "Memory isnt valid anymore!");
+        cap = new_cap;
+    }
+
+    void append(T item) {
+        if (count >= (heap != NULL ? cap : N)) reserve(count + 1);
+        data()[count] = item;
+        count += 1;
+    }
+
+    void append_n(const T *src, i32 n) {
+        reserve(count + n);
+        memcpy(data() + count, src, sizeof(T) * n);
+        count += n;
+    }
+
+    void erase(i32 at, i32 n = 1) {
+        assert(at >= 0 && n >= 0 && at + n <= count);
+        memmove(data() + at, data() + at + n, sizeof(T) * (count - at - n));
+        count -= n;
+    }
+
+    void truncate(i32 n) {
+        assert(n >= 0);
+        if (n < count) count = n;
+    }
+
+    T pop() {
+        return data()[--count];
+    }
+
+    void clear() {
+        count = 0;
+    }
+
+    size_t total_size() const {
+        return sizeof(T) * count;
+    }
+
+    T &operator[](int index) {
+        return data()[index];
+    }
+
+    const T &operator[](int index) const {
+        return data()[index];
+    }
+
+    int len() const {
+        return count;
+    }
+
+    T &last() {
+        return data()[count - 1];
+    }
+
+    const T &last() const {
+        return data()[count - 1];
+    }
+
+    T *begin() {
+        return data();
+    }
+
+    T *end() {
+        return data() + count;
+    }
+
+    const T *begin() const {
+        return data();
+    }
+
+    const T *end() const {
+        return data() + count;
+    }
+
+    span<T> view() {
+        return span<T>{data(), count};
+    }
+};
+
+template <typename T, i32 N>
+static small_daa<T, N> make_small(GrowingArena* arena) {
+    static_assert(std::is_trivially_copyable<T>::value, "small_daa moves items with memcpy");
+    small_daa<T, N> self;
+    self.heap = NULL;
+    self.cap = N;
+    self.count = 0;
+    self.arena = arena;
+    return self;
 }
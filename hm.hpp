@@ -0,0 +1,276 @@
+#pragma once
+
+#include "arena.hpp"
+#include "types.hpp"
+#include <cassert>
+#include <cstring>
+
+// note: build with -DHM_SSE2=0 to force the scalar group scan
+#ifndef HM_SSE2
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HM_SSE2 1
+#else
+#define HM_SSE2 0
+#endif
+#endif
+
+#if HM_SSE2
+#include <emmintrin.h>
+#endif
+
+// Slots are probed a group at a time, one control byte per slot
+#define HM_GROUP 16
+
+// Control bytes: full slots keep the low 7 bits of the hash, the rest is negative
+#define HM_EMPTY ((i8)-128)
+#define HM_DELETED ((i8)-2)
+
+inline u64 hm_mix(u64 x) {
+    // murmur3 finalizer
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ull;
+    x ^= x >> 33;
+    return x;
+}
+
+// Keys hash and compare by their bytes unless there is an overload below
+template <typename K>
+inline u64 hm_hash(const K &key) {
+    u64 hash = 14695981039346656037ull;
+    const unsigned char *bytes = (const unsigned char *)&key;
+    for (size_t i = 0; i < sizeof(K); i += 1) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hm_mix(hash);
+}
+
+inline u64 hm_hash(const i32 &key) { return hm_mix((u64)(u32)key); }
+inline u64 hm_hash(const u32 &key) { return hm_mix(key); }
+inline u64 hm_hash(const i64 &key) { return hm_mix((u64)key); }
+inline u64 hm_hash(const u64 &key) { return hm_mix(key); }
+
+inline u64 hm_hash(const cstring &key) {
+    u64 hash = 14695981039346656037ull;
+    for (const char *it = key; *it; it += 1) {
+        hash ^= (unsigned char)*it;
+        hash *= 1099511628211ull;
+    }
+    return hm_mix(hash);
+}
+
+template <typename K>
+inline bool hm_eq(const K &a, const K &b) {
+    return memcmp(&a, &b, sizeof(K)) == 0;
+}
+
+inline bool hm_eq(const cstring &a, const cstring &b) {
+    return a == b || strcmp(a, b) == 0;
+}
+
+// Bit i set when slot i of the group matches
+inline u32 hm_match(const i8 *group, i8 h2) {
+#if HM_SSE2
+    __m128i ctrl = _mm_loadu_si128((const __m128i *)group);
+    return (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(h2)));
+#else
+    u32 mask = 0;
+    for (u32 i = 0; i < HM_GROUP; i += 1) {
+        if (group[i] == h2) mask |= 1u << i;
+    }
+    return mask;
+#endif
+}
+
+inline u32 hm_match_empty(const i8 *group) {
+    return hm_match(group, HM_EMPTY);
+}
+
+inline u32 hm_match_free(const i8 *group) {
+#if HM_SSE2
+    // empty and deleted are the only control bytes below -1
+    __m128i ctrl = _mm_loadu_si128((const __m128i *)group);
+    return (u32)_mm_movemask_epi8(_mm_cmplt_epi8(ctrl, _mm_set1_epi8(-1)));
+#else
+    u32 mask = 0;
+    for (u32 i = 0; i < HM_GROUP; i += 1) {
+        if (group[i] < -1) mask |= 1u << i;
+    }
+    return mask;
+#endif
+}
+
+template <typename K, typename V>
+struct hma_slot {
+    K key;
+    V value;
+};
+
+template <typename K, typename V>
+struct hma {
+    i8 *ctrl;
+    hma_slot<K, V> *slots;
+    i32 cap;     // multiple of HM_GROUP
+    i32 count;
+    i32 deleted; // tombstones, they still count against the load factor
+    GrowingArena *arena;
+
+    // Slot holding the key, -1 when missing
+    i32 find(const K &key) const {
+        if (cap == 0) return -1;
+
+        u64 hash = hm_hash(key);
+        i8 h2 = (i8)(hash & 0x7f);
+        u32 groups_mask = cap / HM_GROUP - 1;
+        u32 group = (u32)(hash >> 7) & groups_mask;
+
+        for (u32 step = 1;; step += 1) {
+            const i8 *at = ctrl + group * HM_GROUP;
+            for (u32 mask = hm_match(at, h2); mask != 0; mask &= mask - 1) {
+                i32 slot = group * HM_GROUP + __builtin_ctz(mask);
+                if (hm_eq(slots[slot].key, key)) return slot;
+            }
+            if (hm_match_empty(at) != 0) return -1;
+            // triangular probing visits every group once when their count is a power of two
+            group = (group + step) & groups_mask;
+        }
+    }
+
+    V *get(const K &key) const {
+        i32 slot = find(key);
+        return slot < 0 ? NULL : &slots[slot].value;
+    }
+
+    bool has(const K &key) const {
+        return find(key) >= 0;
+    }
+
+    void rehash(i32 new_cap) {
+        i8 *old_ctrl = ctrl;
+        hma_slot<K, V> *old_slots = slots;
+        i32 old_cap = cap;
+
+        ctrl = (i8 *)arena_alloc_aligned(arena, new_cap, HM_GROUP);
+        memset(ctrl, HM_EMPTY, new_cap);
+        slots = arena_alloc<hma_slot<K, V>>(arena, sizeof(hma_slot<K, V>) * new_cap);
+        cap = new_cap;
+        count = 0;
+        deleted = 0;
+
+        for (i32 i = 0; i < old_cap; i += 1) {
+            if (old_ctrl[i] >= 0) insert_new(old_slots[i].key, old_slots[i].value);
+        }
+
+        arena_release(arena, old_slots, sizeof(hma_slot<K, V>) * old_cap);
+        arena_release(arena, old_ctrl, old_cap);
+    }
+
+    // Room for n keys without growing
+    void reserve(i32 n) {
+        i32 need = HM_GROUP;
+        while (need * 7 / 8 < n) need *= 2;
+        if (need > cap) rehash(need);
+    }
+
+    // The key must not be in the map yet
+    V *insert_new(const K &key, const V &value) {
+        u64 hash = hm_hash(key);
+        u32 groups_mask = cap / HM_GROUP - 1;
+        u32 group = (u32)(hash >> 7) & groups_mask;
+
+        for (u32 step = 1;; step += 1) {
+            i8 *at = ctrl + group * HM_GROUP;
+            u32 mask = hm_match_free(at);
+            if (mask != 0) {
+                i32 slot = group * HM_GROUP + __builtin_ctz(mask);
+                if (ctrl[slot] == HM_DELETED) deleted -= 1;
+                ctrl[slot] = (i8)(hash & 0x7f);
+                slots[slot].key = key;
+                slots[slot].value = value;
+                count += 1;
+                return &slots[slot].value;
+            }
+            group = (group + step) & groups_mask;
+        }
+    }
+
+    // Inserts or overwrites, returns where the value lives
+    V *put(const K &key, const V &value) {
+        i32 slot = find(key);
+        if (slot >= 0) {
+            slots[slot].value = value;
+            return &slots[slot].value;
+        }
+
+        if ((count + deleted + 1) * 8 > cap * 7) {
+            // Mostly tombstones: rehash in place instead of doubling
+            rehash(cap == 0 ? HM_GROUP : (count * 2 < cap ? cap : cap * 2));
+        }
+        return insert_new(key, value);
+    }
+
+    bool erase(const K &key) {
+        i32 slot = find(key);
+        if (slot < 0) return false;
+
+        // A group that still has an empty slot never made a probe walk past it
+        i8 *group = ctrl + (slot / HM_GROUP) * HM_GROUP;
+        if (hm_match_empty(group) != 0) {
+            ctrl[slot] = HM_EMPTY;
+        } else {
+            ctrl[slot] = HM_DELETED;
+            deleted += 1;
+        }
+        count -= 1;
+        return true;
+    }
+
+    void clear() {
+        if (cap != 0) memset(ctrl, HM_EMPTY, cap);
+        count = 0;
+        deleted = 0;
+    }
+
+    int len() const {
+        return count;
+    }
+
+    struct iterator {
+        const hma *map;
+        i32 at;
+
+        void skip() {
+            while (at < map->cap && map->ctrl[at] < 0) at += 1;
+        }
+
+        hma_slot<K, V> &operator*() const { return map->slots[at]; }
+        hma_slot<K, V> *operator->() const { return &map->slots[at]; }
+
+        iterator &operator++() {
+            at += 1;
+            skip();
+            return *this;
+        }
+
+        bool operator!=(const iterator &other) const { return at != other.at; }
+    };
+
+    iterator begin() const {
+        iterator it{this, 0};
+        it.skip();
+        return it;
+    }
+
+    iterator end() const {
+        return iterator{this, cap};
+    }
+};
+
+template <typename K, typename V>
+static hma<K, V> make_map(GrowingArena *arena, i32 initial_cap = 0) {
+    hma<K, V> map{NULL, NULL, 0, 0, 0, arena};
+    if (initial_cap > 0) map.reserve(initial_cap);
+    return map;
+}
@@ -6,15 +6,21 @@
 #include <raymath.h>
 
 #include "arena.hpp"
+#include "bitgrid.hpp"
 #include "da.hpp"
+#include "particles.hpp"
+#include "str.hpp"
 #include "ui.hpp"
 
 #if defined(PLATFORM_WEB)
 #include <emscripten/emscripten.h>
 #endif
 
-GrowingArena allocator;
-GrowingArena temp_allocator;
+GrowingArena allocator{.recycle = true};
+// UI text that repeats frame after frame, formatted once
+StrIntern strings{&allocator};
+// note: kept out of allocator, undo must not roll particles back
+GrowingArena particle_allocator;
 
 template<typename T>
 T* alloc(size_t size, GrowingArena* arena = &allocator) {
@@ -36,10 +42,12 @@ static vec2 current_hover{};
 static float hover_timer{};
 
 static int map[MAP_SZ*MAP_SZ]{};
-static int filled_map[MAP_SZ*MAP_SZ]{};
+static bitgrid<MAP_SZ, MAP_SZ> filled_map{};
 
 struct Connection {
-	daa<vec2> points;
+	// note: a path across the board fits inline, but update() lets a path run over its own
+	// cells, so a long one can still spill into allocator
+	small_daa<vec2, MAP_SZ * MAP_SZ> points;
 	vec2 start;
 	vec2 end;
 	int id;
@@ -49,7 +57,7 @@ struct Connection {
 
 Connection create(vec2 start, vec2 end, int id, Color color) {
 	Connection c{};
-	c.points = make<vec2>(&allocator);
+	c.points = make_small<vec2, MAP_SZ * MAP_SZ>(&allocator);
 	c.start = start;
 	c.end = end;
 	c.id = id;
@@ -218,6 +226,9 @@ static Level current_level;
 
 static Connection *current_connection;
 
+// Board state before the last edit, Z puts it back
+static ArenaSnapshot undo{};
+
 static Camera2D cam{};
 static RenderTexture2D game, post_process_1;
 
@@ -296,71 +307,58 @@ enum ParticleType {
 	PATH,
 };
 
+// What a spawn asks for, the spawner keeps its fields in separate arrays
 struct Particle {
 	ParticleType type;
-	vec2 pos, vel, dir, size;
+	vec2 pos, vel, dir;
 	vec2 off;
 	Color color;
 	float t;
-	bool valid;
 };
 
 #define MAX_PARTICLES 1024
 struct ParticleSpawner {
-	Particle particles[MAX_PARTICLES];
+	// Live PATH particles, packed, a dead one gets the last one swapped in
+	ParticleSoa particles;
+	i64 spawned;
+	i64 dropped; // spawns lost because every slot was busy
 };
 static ParticleSpawner particle_spawner{};
 
 void update_particles() {
-	for(auto &p : particle_spawner.particles) {
-		if (!p.valid) continue;
-		switch(p.type) {
-			case NONE: break;
-			case PATH: {
-					if (p.dir.y != 0) {
-						p.pos.x += (p.vel.x * GetFrameTime());
-						p.pos.y += (p.vel.y * p.dir.y * GetFrameTime());
-					} else {
-						p.pos.x += (p.vel.x * p.dir.x * GetFrameTime());
-						p.pos.y += (p.vel.y * GetFrameTime());						
-					}
-					p.t += GetFrameTime();
-					p.size.x = 8 * (p.t / PATH_ALIIVE_TIME);
-					if (p.t >= PATH_ALIIVE_TIME) {
-						p.valid = false;
-					}
-			} break;
-		}
-	}
+	particles_integrate(&particle_spawner.particles, GetFrameTime());
+	particles_cull(&particle_spawner.particles, particle_life_limit(PATH_ALIIVE_TIME));
 }
 
 void render_particle() {
-	for(auto p : particle_spawner.particles) {
-		if (!p.valid) continue;
-		switch(p.type) {
-			case NONE: break;
-			case PATH: {
-					float alpha = 1 * (p.t / PATH_ALIIVE_TIME);
-					DrawCircleV(p.pos, p.size.x, ColorAlpha(p.color, alpha));
-			} break;
-		}
+	auto &particles = particle_spawner.particles;
+	f32 *pos_x = particles.field<PARTICLE_POS_X>();
+	f32 *pos_y = particles.field<PARTICLE_POS_Y>();
+	f32 *t = particles.field<PARTICLE_T>();
+	u32 *colors = particles.field<PARTICLE_COLOR>();
+
+	for (int i = 0; i < particles.count; i += 1) {
+		float size = 8 * (t[i] / PATH_ALIIVE_TIME);
+		float alpha = 1 * (t[i] / PATH_ALIIVE_TIME);
+		Color color;
+		memcpy(&color, &colors[i], sizeof(color));
+		DrawCircleV(v2(pos_x[i], pos_y[i]), size, ColorAlpha(color, alpha));
 	}
 }
 
 void add_particle(Particle particle) {
-	for (auto &p : particle_spawner.particles) {
-		if (p.valid) continue;
-		p.valid = true;
-		p.color = particle.color;
-		p.pos = particle.pos;
-		p.vel = particle.vel;
-		p.dir = particle.dir;
-		p.t = particle.t;
-		p.size = particle.size;
-		p.type = particle.type;
-		p.off = particle.off;
-		break;
+	// note: NONE particles never moved or drew, there is nothing to keep
+	if (particle.type != PATH) return;
+	if (particle_spawner.particles.count == MAX_PARTICLES) {
+		particle_spawner.dropped += 1;
+		return;
 	}
+
+	u32 color;
+	memcpy(&color, &particle.color, sizeof(color));
+	particle_spawner.particles.append(particle.pos.x, particle.pos.y, particle.vel.x, particle.vel.y,
+	                                  particle.dir.x, particle.dir.y, particle.t, color);
+	particle_spawner.spawned += 1;
 }
 
 void add_particles(Particle particle, int amnt) {
@@ -371,11 +369,12 @@ void add_particles(Particle particle, int amnt) {
 
 void next_level() {
 	memset(map, 0, sizeof(int) * (MAP_SZ * MAP_SZ));
-	memset(filled_map, 0, sizeof(int) * (MAP_SZ * MAP_SZ));
+	filled_map.clear();
 	current_level = levels[++level_id];
+	undo.taken = false;
 	
 	for(int i = 0; i < current_level.nc; i+=1) {
-		auto c = current_level.connections[i];
+		auto &c = current_level.connections[i];
 		int start_index = c.start.y * MAP_SZ + c.start.x;
 		int end_index = c.end.y * MAP_SZ + c.end.x;
 		map[start_index] = c.id;
@@ -425,6 +424,14 @@ void init() {
 
 	start_anim = true;
 	quad_info.y = window_size.x;
+
+	particle_spawner.particles = make_particles(&particle_allocator, MAX_PARTICLES);
+
+	arena_snapshot_watch(&undo, map, sizeof(map));
+	arena_snapshot_watch(&undo, &filled_map, sizeof(filled_map));
+	arena_snapshot_watch(&undo, &current_level, sizeof(current_level));
+	// note: interned text lives in allocator too, the table has to roll back with it
+	arena_snapshot_watch(&undo, &strings, sizeof(strings));
 }
 
 void add_path_particle(vec2 pos, vec2 dir) {
@@ -438,7 +445,6 @@ void add_path_particle(vec2 pos, vec2 dir) {
 			.pos = render_pos,
 			.vel = v2(GetRandomValue(-100, 100), GetRandomValue(-100, 100)),
 			.dir = dir,
-			.size = v2of(8),
 			.off = dir.x != 0 ? v2(GetRandomValue(-5, 5), 0) : v2(0, GetRandomValue(-5, 5)),
 			.color = current_connection->color,
 			.t = 0,
@@ -456,6 +462,16 @@ void update() {
 	volume = Lerp(volume, MUSIC_VOLUME, 0.1 * GetFrameTime());
 	SetMusicVolume(loop_back, volume);
 	UpdateMusicStream(loop_back);
+
+	if (IsKeyPressed(KEY_F1)) {
+		arena_report(&allocator, "allocator");
+		printf("particles: %d live, %lld spawned, %lld dropped\n",
+		       particle_spawner.particles.count, particle_spawner.spawned, particle_spawner.dropped);
+	}
+
+	if (current_connection == NULL && IsKeyPressed(KEY_Z) && arena_snapshot_restore(&undo)) {
+		undo.taken = false;
+	}
 	
 	if (start_anim) {
 		if (quad_info.y < window_size.x) {
@@ -496,13 +512,15 @@ void update() {
 	};
 	
 	auto is_free = [](vec2 at) {
-		return filled_map[int(at.y * MAP_SZ + at.x)] == 0;
+		return !filled_map.get(at.x, at.y);
 	};
 	
 
 	// Is connnection
 
 	if (in_bounds(hover_cell)) {
+		// Points only reach allocator once a path outgrows its inline storage
+		ARENA_TAG(&allocator, "paths");
 		hover_cell.x = Clamp(hover_cell.x, 0, MAP_SZ - 1);
 		hover_cell.y = Clamp(hover_cell.y, 0, MAP_SZ - 1);
 	
@@ -510,11 +528,11 @@ void update() {
 			for (auto &c : current_level.connections) {
 				// Check if hover is either start or end
 				if ((hover_cell == c.start || hover_cell == c.end) && id_at(hover_cell) == c.id) {
+					arena_snapshot_take(&undo, &allocator);
 					current_connection = &c;
 					if (c.points.count > 0) {
-						for (int i = 0; i < current_connection->points.count; i+= 1) {
-							vec2 p = current_connection->points.items[i];
-							filled_map[int(p.y * MAP_SZ + p.x)] = 0;	
+						for (vec2 p : current_connection->points) {
+							filled_map.unset(p.x, p.y);	
 						}
 						c.done = false;	
 						c.points.clear();				
@@ -548,9 +566,8 @@ void update() {
 					has_target = true;
 				}
 			} else {
-				for (int i = 0; i < current_connection->points.count; i+= 1) {
-					vec2 p = current_connection->points.items[i];
-					filled_map[int(p.y * MAP_SZ + p.x)] = 0;	
+				for (vec2 p : current_connection->points) {
+					filled_map.unset(p.x, p.y);	
 				}
 				current_connection->points.clear();
 				current_connection = NULL;
@@ -566,9 +583,8 @@ void update() {
 			}
 		}
 		if (has_target) {
-			for (int i = 0; i < current_connection->points.count; i+= 1) {
-				vec2 p = current_connection->points.items[i];
-				filled_map[int(p.y * MAP_SZ + p.x)] = 1;	
+			for (vec2 p : current_connection->points) {
+				filled_map.set(p.x, p.y);	
 			}
 			current_connection->done = true;
 			current_connection = NULL;
@@ -600,12 +616,12 @@ void render() {
 			}	
 			// :line
 			{
-				for (auto c : current_level.connections) {
+				for (auto &c : current_level.connections) {
 					if (c.points.count > 1) {
-						vec2 last_point = c.points.items[0];
+						vec2 last_point = c.points[0];
 						for(int i = 1; i < c.points.count; i++) {
-							DrawLineEx((last_point * CELL_SZ) + CELL_SZ / 2.f, (c.points.items[i] * CELL_SZ) + CELL_SZ / 2.f, LINE_WIDTH, c.color);
-							last_point = c.points.items[i];
+							DrawLineEx((last_point * CELL_SZ) + CELL_SZ / 2.f, (c.points[i] * CELL_SZ) + CELL_SZ / 2.f, LINE_WIDTH, c.color);
+							last_point = c.points[i];
 						}
 					}
 				}
@@ -643,7 +659,7 @@ void render() {
 #if 0
 			for (int y = 0; y < MAP_SZ; y++) {
 				for (int x = 0; x < MAP_SZ; x++) {
-					int at = filled_map[y*MAP_SZ+x];
+					int at = filled_map.get(x, y);
 					int at2 = map[y*MAP_SZ+x];
 					vec2 pos = v2(x, y) * CELL_SZ;
 					if (at == 0) continue;
@@ -703,7 +719,7 @@ void render() {
 #if 0
 		if (current_connection) {
 			for (int i = 0; i < current_connection->points.count; i+=1) {
-				DrawTextEx(font16, TextFormat("[%d] %f %f", i, current_connection->points.items[i].x, current_connection->points.items[i].y), v2(10, i * 16), 16, 2, WHITE);
+				DrawTextEx(font16, TextFormat("[%d] %f %f", i, current_connection->points[i].x, current_connection->points[i].y), v2(10, i * 16), 16, 2, WHITE);
 			}
 		}
 		// :debug
@@ -726,7 +742,7 @@ void render() {
 				pad_b(&dnext, 10);
 				
 				bool enabled = true;
-				for (auto c : current_level.connections) {
+				for (auto &c : current_level.connections) {
 					if (c.id == 0) continue;
 					if (!c.done) {
 						enabled = false;
@@ -759,7 +775,8 @@ void render() {
 						text_info.y = Lerp(text_info.y, 0, 0.1);
 					}
 					
-					const char* text = TextFormat("LEVEL %d", level_id + 1);
+					ARENA_TAG(&allocator, "text");
+					const char* text = str_internf(&strings, "LEVEL %d", level_id + 1);
 					auto dlabel = text_size(font64, text);
 				
 					center(screen, &dlabel);
@@ -0,0 +1,176 @@
+#pragma once
+
+#include "arena.hpp"
+#include "soa.hpp"
+#include "types.hpp"
+#include <cmath>
+
+#define PARTICLES_SCALAR 0
+#define PARTICLES_SSE2 1
+#define PARTICLES_AVX2 2
+#define PARTICLES_NEON 3
+#define PARTICLES_WASM 4
+
+// note: build with -DPARTICLES_SIMD=0 to force the scalar kernel
+#ifndef PARTICLES_SIMD
+#if defined(__AVX2__)
+#define PARTICLES_SIMD PARTICLES_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PARTICLES_SIMD PARTICLES_SSE2
+#elif defined(__ARM_NEON)
+#define PARTICLES_SIMD PARTICLES_NEON
+#elif defined(__wasm_simd128__)
+#define PARTICLES_SIMD PARTICLES_WASM
+#else
+#define PARTICLES_SIMD PARTICLES_SCALAR
+#endif
+#endif
+
+#if PARTICLES_SIMD == PARTICLES_AVX2
+#include <immintrin.h>
+#elif PARTICLES_SIMD == PARTICLES_SSE2
+#include <emmintrin.h>
+#elif PARTICLES_SIMD == PARTICLES_NEON
+#include <arm_neon.h>
+#elif PARTICLES_SIMD == PARTICLES_WASM
+#include <wasm_simd128.h>
+#endif
+
+// Field indices into ParticleSoa
+enum ParticleField {
+    PARTICLE_POS_X,
+    PARTICLE_POS_Y,
+    PARTICLE_VEL_X,
+    PARTICLE_VEL_Y,
+    PARTICLE_DIR_X,
+    PARTICLE_DIR_Y,
+    PARTICLE_T,
+    PARTICLE_COLOR, // rgba bytes, kernels never touch it
+};
+
+using ParticleSoa = soa<f32, f32, f32, f32, f32, f32, f32, u32>;
+
+inline ParticleSoa make_particles(GrowingArena *arena, i32 initial_cap = 0) {
+    return make_soa<f32, f32, f32, f32, f32, f32, f32, u32>(arena, initial_cap);
+}
+
+inline const char *particles_simd_name() {
+#if PARTICLES_SIMD == PARTICLES_AVX2
+    return "avx2";
+#elif PARTICLES_SIMD == PARTICLES_SSE2
+    return "sse2";
+#elif PARTICLES_SIMD == PARTICLES_NEON
+    return "neon";
+#elif PARTICLES_SIMD == PARTICLES_WASM
+    return "wasm_simd";
+#else
+    return "scalar";
+#endif
+}
+
+// Smallest float that is >= life, so `t >= limit` on floats agrees with comparing t against
+// a double lifetime exactly
+inline f32 particle_life_limit(double life) {
+    f32 limit = (f32)life;
+    if ((double)limit < life) limit = nextafterf(limit, INFINITY);
+    return limit;
+}
+
+// Particles moving vertically (dir.y != 0) drift sideways unscaled, the others drift vertically
+// unscaled. Written as a select of the scale factors instead of a branch, the products are
+// evaluated in the same order as the branchy version so the results are bit for bit the same.
+inline void particles_integrate_scalar(ParticleSoa *self, i32 from, i32 to, f32 dt) {
+    f32 *pos_x = self->field<PARTICLE_POS_X>(), *pos_y = self->field<PARTICLE_POS_Y>();
+    f32 *vel_x = self->field<PARTICLE_VEL_X>(), *vel_y = self->field<PARTICLE_VEL_Y>();
+    f32 *dir_x = self->field<PARTICLE_DIR_X>(), *dir_y = self->field<PARTICLE_DIR_Y>();
+    f32 *t = self->field<PARTICLE_T>();
+
+    for (i32 i = from; i < to; i += 1) {
+        bool vertical = dir_y[i] != 0;
+        f32 scale_x = vertical ? 1.0f : dir_x[i];
+        f32 scale_y = vertical ? dir_y[i] : 1.0f;
+        pos_x[i] += vel_x[i] * scale_x * dt;
+        pos_y[i] += vel_y[i] * scale_y * dt;
+        t[i] += dt;
+    }
+}
+
+inline void particles_integrate(ParticleSoa *self, f32 dt) {
+    i32 i = 0;
+#if PARTICLES_SIMD != PARTICLES_SCALAR
+    f32 *pos_x = self->field<PARTICLE_POS_X>(), *pos_y = self->field<PARTICLE_POS_Y>();
+    f32 *vel_x = self->field<PARTICLE_VEL_X>(), *vel_y = self->field<PARTICLE_VEL_Y>();
+    f32 *dir_x = self->field<PARTICLE_DIR_X>(), *dir_y = self->field<PARTICLE_DIR_Y>();
+    f32 *t = self->field<PARTICLE_T>();
+#endif
+
+#if PARTICLES_SIMD == PARTICLES_AVX2
+    __m256 vdt = _mm256_set1_ps(dt), one = _mm256_set1_ps(1.0f), zero = _mm256_setzero_ps();
+    for (; i + 8 <= self->count; i += 8) {
+        __m256 dx = _mm256_loadu_ps(dir_x + i), dy = _mm256_loadu_ps(dir_y + i);
+        // unordered so NaN counts as != 0 like the scalar compare
+        __m256 vertical = _mm256_cmp_ps(dy, zero, _CMP_NEQ_UQ);
+        __m256 scale_x = _mm256_blendv_ps(dx, one, vertical);
+        __m256 scale_y = _mm256_blendv_ps(one, dy, vertical);
+        __m256 step_x = _mm256_mul_ps(_mm256_mul_ps(_mm256_loadu_ps(vel_x + i), scale_x), vdt);
+        __m256 step_y = _mm256_mul_ps(_mm256_mul_ps(_mm256_loadu_ps(vel_y + i), scale_y), vdt);
+        _mm256_storeu_ps(pos_x + i, _mm256_add_ps(_mm256_loadu_ps(pos_x + i), step_x));
+        _mm256_storeu_ps(pos_y + i, _mm256_add_ps(_mm256_loadu_ps(pos_y + i), step_y));
+        _mm256_storeu_ps(t + i, _mm256_add_ps(_mm256_loadu_ps(t + i), vdt));
+    }
+#elif PARTICLES_SIMD == PARTICLES_SSE2
+    __m128 vdt = _mm_set1_ps(dt), one = _mm_set1_ps(1.0f), zero = _mm_setzero_ps();
+    for (; i + 4 <= self->count; i += 4) {
+        __m128 dx = _mm_loadu_ps(dir_x + i), dy = _mm_loadu_ps(dir_y + i);
+        __m128 vertical = _mm_cmpneq_ps(dy, zero);
+        __m128 scale_x = _mm_or_ps(_mm_and_ps(vertical, one), _mm_andnot_ps(vertical, dx));
+        __m128 scale_y = _mm_or_ps(_mm_and_ps(vertical, dy), _mm_andnot_ps(vertical, one));
+        __m128 step_x = _mm_mul_ps(_mm_mul_ps(_mm_loadu_ps(vel_x + i), scale_x), vdt);
+        __m128 step_y = _mm_mul_ps(_mm_mul_ps(_mm_loadu_ps(vel_y + i), scale_y), vdt);
+        _mm_storeu_ps(pos_x + i, _mm_add_ps(_mm_loadu_ps(pos_x + i), step_x));
+        _mm_storeu_ps(pos_y + i, _mm_add_ps(_mm_loadu_ps(pos_y + i), step_y));
+        _mm_storeu_ps(t + i, _mm_add_ps(_mm_loadu_ps(t + i), vdt));
+    }
+#elif PARTICLES_SIMD == PARTICLES_NEON
+    float32x4_t vdt = vdupq_n_f32(dt), one = vdupq_n_f32(1.0f), zero = vdupq_n_f32(0.0f);
+    for (; i + 4 <= self->count; i += 4) {
+        float32x4_t dx = vld1q_f32(dir_x + i), dy = vld1q_f32(dir_y + i);
+        uint32x4_t vertical = vmvnq_u32(vceqq_f32(dy, zero));
+        float32x4_t scale_x = vbslq_f32(vertical, one, dx);
+        float32x4_t scale_y = vbslq_f32(vertical, dy, one);
+        // note: separate mul and add, a fused multiply-add would round differently
+        float32x4_t step_x = vmulq_f32(vmulq_f32(vld1q_f32(vel_x + i), scale_x), vdt);
+        float32x4_t step_y = vmulq_f32(vmulq_f32(vld1q_f32(vel_y + i), scale_y), vdt);
+        vst1q_f32(pos_x + i, vaddq_f32(vld1q_f32(pos_x + i), step_x));
+        vst1q_f32(pos_y + i, vaddq_f32(vld1q_f32(pos_y + i), step_y));
+        vst1q_f32(t + i, vaddq_f32(vld1q_f32(t + i), vdt));
+    }
+#elif PARTICLES_SIMD == PARTICLES_WASM
+    v128_t vdt = wasm_f32x4_splat(dt), one = wasm_f32x4_splat(1.0f), zero = wasm_f32x4_splat(0.0f);
+    for (; i + 4 <= self->count; i += 4) {
+        v128_t dx = wasm_v128_load(dir_x + i), dy = wasm_v128_load(dir_y + i);
+        v128_t vertical = wasm_f32x4_ne(dy, zero);
+        v128_t scale_x = wasm_v128_bitselect(one, dx, vertical);
+        v128_t scale_y = wasm_v128_bitselect(dy, one, vertical);
+        v128_t step_x = wasm_f32x4_mul(wasm_f32x4_mul(wasm_v128_load(vel_x + i), scale_x), vdt);
+        v128_t step_y = wasm_f32x4_mul(wasm_f32x4_mul(wasm_v128_load(vel_y + i), scale_y), vdt);
+        wasm_v128_store(pos_x + i, wasm_f32x4_add(wasm_v128_load(pos_x + i), step_x));
+        wasm_v128_store(pos_y + i, wasm_f32x4_add(wasm_v128_load(pos_y + i), step_y));
+        wasm_v128_store(t + i, wasm_f32x4_add(wasm_v128_load(t + i), vdt));
+    }
+#endif
+
+    particles_integrate_scalar(self, i, self->count, dt);
+}
+
+// Swap-removes every particle whose t reached limit, see particle_life_limit
+inline void particles_cull(ParticleSoa *self, f32 limit) {
+    f32 *t = self->field<PARTICLE_T>();
+    for (i32 i = 0; i < self->count;) {
+        if (t[i] >= limit) {
+            self->swap_remove(i);
+        } else {
+            i += 1;
+        }
+    }
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "arena.hpp"
+#include "types.hpp"
+#include <cassert>
+#include <cstring>
+
+// Refers to a pool object. gen changes every time the slot is freed, so a handle that
+// outlived its object is caught instead of silently pointing at the next tenant.
+struct Handle {
+    u32 index;
+    u32 gen; // 0 is never handed out, a zeroed Handle is always invalid
+};
+
+inline bool operator==(Handle a, Handle b) {
+    return a.index == b.index && a.gen == b.gen;
+}
+
+inline bool operator!=(Handle a, Handle b) {
+    return !(a == b);
+}
+
+struct PoolSlot {
+    u32 gen;
+    i32 dense;     // where the object lives in items while alive
+    i32 next_free; // free list link while dead
+};
+
+// Live objects stay packed at the front of items (removal swaps the last one in), slots map
+// handles onto them and keep a free list, so spawn/despawn/get are O(1).
+template <typename T>
+struct pool {
+    T *items;
+    i32 *dense_slot; // slot of items[i]
+    PoolSlot *slots;
+    i32 count;
+    i32 cap;
+    i32 free_head;
+    GrowingArena *arena;
+
+    // note: pointers from get() don't survive growing, handles do
+    void grow(i32 new_cap) {
+        items = arena_realloc<T>(arena, items, sizeof(T) * cap, sizeof(T) * new_cap);
+        dense_slot = arena_realloc<i32>(arena, dense_slot, sizeof(i32) * cap, sizeof(i32) * new_cap);
+        slots = arena_realloc<PoolSlot>(arena, slots, sizeof(PoolSlot) * cap, sizeof(PoolSlot) * new_cap);
+
+        for (i32 i = new_cap - 1; i >= cap; i -= 1) {
+            slots[i].gen = 1;
+            slots[i].dense = -1;
+            slots[i].next_free = free_head;
+            free_head = i;
+        }
+        cap = new_cap;
+    }
+
+    Handle spawn(const T &value) {
+        if (free_head < 0) grow(cap == 0 ? 64 : cap * 2);
+
+        i32 slot = free_head;
+        free_head = slots[slot].next_free;
+
+        items[count] = value;
+        dense_slot[count] = slot;
+        slots[slot].dense = count;
+        count += 1;
+
+        return Handle{(u32)slot, slots[slot].gen};
+    }
+
+    // note: free slots keep their gen until reused, fresh ones even match gen 1, so dense decides
+    bool alive(Handle h) const {
+        return h.gen != 0 && (i32)h.index < cap && slots[h.index].gen == h.gen && slots[h.index].dense >= 0;
+    }
+
+    T *get(Handle h) const {
+        return alive(h) ? &items[slots[h.index].dense] : NULL;
+    }
+
+    bool despawn(Handle h) {
+        if (!alive(h)) return false;
+
+        i32 at = slots[h.index].dense;
+        i32 last = count - 1;
+        items[at] = items[last];
+        dense_slot[at] = dense_slot[last];
+        slots[dense_slot[at]].dense = at;
+        count -= 1;
+
+        slots[h.index].gen += 1;
+        if (slots[h.index].gen == 0) slots[h.index].gen = 1;
+        slots[h.index].dense = -1;
+        slots[h.index].next_free = free_head;
+        free_head = (i32)h.index;
+        return true;
+    }
+
+    // Handle of the object at items[i], handy while iterating
+    Handle handle_at(i32 i) const {
+        i32 slot = dense_slot[i];
+        return Handle{(u32)slot, slots[slot].gen};
+    }
+
+    // Despawns everything, outstanding handles all go stale
+    void clear() {
+        while (count > 0) despawn(handle_at(count - 1));
+    }
+
+    int len() const {
+        return count;
+    }
+
+    T *begin() const {
+        return items;
+    }
+
+    T *end() const {
+        return items + count;
+    }
+};
+
+template <typename T>
+static pool<T> make_pool(GrowingArena *arena, i32 initial_cap = 0) {
+    pool<T> self{NULL, NULL, NULL, 0, 0, -1, arena};
+    if (initial_cap > 0) self.grow(initial_cap);
+    return self;
+}
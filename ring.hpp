@@ -0,0 +1,149 @@
+#pragma once
+
+#include "arena.hpp"
+#include "types.hpp"
+#include <atomic>
+#include <cassert>
+
+// Keeps the producer and consumer indices of spsc on different cache lines
+#define RING_CACHE_LINE 64
+
+enum RingPolicy {
+    RING_OVERWRITE, // a full ring drops its oldest item
+    RING_REJECT,    // a full ring refuses the push
+};
+
+inline u32 ring_round_cap(u32 cap) {
+    u32 pow2 = 1;
+    while (pow2 < cap) pow2 *= 2;
+    return pow2;
+}
+
+// Fixed capacity FIFO. head and tail only ever count up, the power of two capacity turns
+// wrap around into a mask and unsigned overflow keeps tail - head right.
+template <typename T>
+struct ring {
+    T *items;
+    u32 mask;
+    u32 head; // oldest item
+    u32 tail; // next free slot
+    RingPolicy policy;
+
+    // false when the ring was full and the policy is RING_REJECT
+    bool push(const T &item) {
+        if (tail - head > mask) {
+            if (policy == RING_REJECT) return false;
+            head += 1;
+        }
+        items[tail & mask] = item;
+        tail += 1;
+        return true;
+    }
+
+    bool pop(T *out) {
+        if (head == tail) return false;
+        *out = items[head & mask];
+        head += 1;
+        return true;
+    }
+
+    // i = 0 is the oldest item
+    T &operator[](u32 i) const {
+        assert(i < len());
+        return items[(head + i) & mask];
+    }
+
+    T &front() const {
+        return items[head & mask];
+    }
+
+    T &back() const {
+        return items[(tail - 1) & mask];
+    }
+
+    u32 len() const {
+        return tail - head;
+    }
+
+    u32 capacity() const {
+        return mask + 1;
+    }
+
+    bool empty() const {
+        return head == tail;
+    }
+
+    bool full() const {
+        return tail - head > mask;
+    }
+
+    void clear() {
+        head = tail;
+    }
+};
+
+// note: cap is rounded up to a power of two
+template <typename T>
+static ring<T> make_ring(GrowingArena *arena, u32 cap, RingPolicy policy = RING_OVERWRITE) {
+    cap = ring_round_cap(cap);
+    T *items = arena_alloc<T>(arena, sizeof(T) * cap);
+    assert(items != NULL && "Arena allocator failed!");
+    return ring<T>{items, cap - 1, 0, 0, policy};
+}
+
+// :spsc
+// Wait-free queue between exactly one producer thread and one consumer thread. Each side keeps
+// a stale copy of the other's index and only rereads the shared one when the copy says full/empty.
+template <typename T>
+struct spsc {
+    T *items;
+    u32 mask;
+
+    alignas(RING_CACHE_LINE) std::atomic<u32> tail; // written by the producer
+    u32 head_cache;
+
+    alignas(RING_CACHE_LINE) std::atomic<u32> head; // written by the consumer
+    u32 tail_cache;
+
+    // Producer only, false when full
+    bool push(const T &item) {
+        u32 at = tail.load(std::memory_order_relaxed);
+        if (at - head_cache > mask) {
+            head_cache = head.load(std::memory_order_acquire);
+            if (at - head_cache > mask) return false;
+        }
+        items[at & mask] = item;
+        tail.store(at + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only, false when empty
+    bool pop(T *out) {
+        u32 at = head.load(std::memory_order_relaxed);
+        if (at == tail_cache) {
+            tail_cache = tail.load(std::memory_order_acquire);
+            if (at == tail_cache) return false;
+        }
+        *out = items[at & mask];
+        head.store(at + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Only a snapshot when the other side is running
+    u32 len() const {
+        return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+    }
+};
+
+// Set it up before the threads start, the arena is only touched here
+template <typename T>
+static void spsc_init(spsc<T> *self, GrowingArena *arena, u32 cap) {
+    cap = ring_round_cap(cap);
+    self->items = arena_alloc<T>(arena, sizeof(T) * cap);
+    assert(self->items != NULL && "Arena allocator failed!");
+    self->mask = cap - 1;
+    self->tail.store(0, std::memory_order_relaxed);
+    self->head.store(0, std::memory_order_relaxed);
+    self->head_cache = 0;
+    self->tail_cache = 0;
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "arena.hpp"
+#include "da.hpp"
+#include "types.hpp"
+#include <cassert>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+// Every field array starts on a cache line, so SIMD kernels can use aligned loads
+#define SOA_ALIGN 64
+// cap stays a multiple of this many items, kernels may run whole vectors past count
+#define SOA_LANES 16
+
+// Struct of arrays: field I of item i lives at field<I>()[i]. All arrays share count and cap,
+// append and swap_remove keep them in step.
+template <typename... Fields>
+struct soa {
+    static_assert(sizeof...(Fields) > 0, "soa needs at least one field");
+    static_assert((std::is_trivially_copyable<Fields>::value && ...), "soa moves fields with memcpy");
+
+    template <size_t I>
+    using field_t = typename std::tuple_element<I, std::tuple<Fields...>>::type;
+
+    void *arrays[sizeof...(Fields)];
+    i32 count;
+    i32 cap;
+    GrowingArena *arena;
+
+    template <size_t I>
+    field_t<I> *field() const {
+        return (field_t<I> *)arrays[I];
+    }
+
+    // note: like every arena pointer the spans go stale when the soa grows
+    template <size_t I>
+    span<field_t<I>> view() const {
+        return span<field_t<I>>{field<I>(), count};
+    }
+
+    void grow(i32 new_cap) {
+        size_t sizes[] = {sizeof(Fields)...};
+        for (size_t i = 0; i < sizeof...(Fields); i += 1) {
+            void *mem = arena_alloc_aligned(arena, sizes[i] * new_cap, SOA_ALIGN);
+            assert(mem != NULL && "Arena allocator failed!");
+            if (arrays[i] != NULL) {
+                memcpy(mem, arrays[i], sizes[i] * count);
+                arena_release(arena, arrays[i], sizes[i] * cap);
+            }
+            // Padding past count is zeroed so kernels reading whole vectors see plain numbers
+            memset((u8 *)mem + sizes[i] * count, 0, sizes[i] * (new_cap - count));
+            arrays[i] = mem;
+        }
+        cap = new_cap;
+    }
+
+    // Items past count are kept zeroed, whatever vacates them calls this
+    void zero(i32 from, i32 n) {
+        size_t sizes[] = {sizeof(Fields)...};
+        for (size_t i = 0; i < sizeof...(Fields); i += 1) {
+            memset((u8 *)arrays[i] + sizes[i] * from, 0, sizes[i] * n);
+        }
+    }
+
+    void reserve(i32 n) {
+        if (n <= cap) return;
+
+        i32 new_cap = cap == 0 ? SOA_LANES : cap;
+        while (new_cap < n) new_cap *= 2;
+        grow(new_cap);
+    }
+
+    template <size_t... Is>
+    void store(i32 at, std::index_sequence<Is...>, const Fields &...values) {
+        ((field<Is>()[at] = values), ...);
+    }
+
+    // Returns the index of the new item
+    i32 append(const Fields &...values) {
+        reserve(count + 1);
+        store(count, std::index_sequence_for<Fields...>{}, values...);
+        return count++;
+    }
+
+    template <size_t... Is>
+    void move(i32 to, i32 from, std::index_sequence<Is...>) {
+        ((field<Is>()[to] = field<Is>()[from]), ...);
+    }
+
+    // O(1) removal, the last item takes the place of the removed one
+    void swap_remove(i32 at) {
+        assert(at >= 0 && at < count);
+        count -= 1;
+        if (at != count) move(at, count, std::index_sequence_for<Fields...>{});
+        zero(count, 1);
+    }
+
+    void clear() {
+        if (count > 0) zero(0, count);
+        count = 0;
+    }
+
+    int len() const {
+        return count;
+    }
+};
+
+template <typename... Fields>
+static soa<Fields...> make_soa(GrowingArena *arena, i32 initial_cap = 0) {
+    soa<Fields...> self{};
+    self.arena = arena;
+    if (initial_cap > 0) self.reserve(initial_cap);
+    return self;
+}
@@ -0,0 +1,211 @@
+#pragma once
+
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+
+#include "arena.hpp"
+#include "types.hpp"
+
+// First formatting pass writes into a block this big, it gets trimmed or grown in place afterwards
+#define STR_FORMAT_GUESS 64
+#define STR_INTERN_INITIAL_CAP 64
+#define STR_KEY_MAX 256
+
+// Exact size formatting: the text is written at the arena top and the block is trimmed to it,
+// only output longer than the guess gets formatted a second time.
+template <typename... Args>
+static u8 *arena_sprintf(GrowingArena *arena, const char *const format, Args... args) {
+    u8 *mem = arena_alloc<u8>(arena, STR_FORMAT_GUESS);
+    i32 n = snprintf(mem, STR_FORMAT_GUESS, format, args...);
+    assert(n >= 0 && "Invalid format string!");
+
+    if (n < STR_FORMAT_GUESS) {
+        arena_resize_top(arena, mem, STR_FORMAT_GUESS, n + 1);
+        return mem;
+    }
+
+    mem = arena_realloc<u8>(arena, mem, STR_FORMAT_GUESS, n + 1);
+    snprintf(mem, n + 1, format, args...);
+    return mem;
+}
+
+// Growing, always nul terminated text. Appends extend the block in place while it is the arena top.
+struct StrBuilder {
+    u8 *items;
+    i32 count; // without the terminator
+    i32 cap;
+    GrowingArena *arena;
+
+    void reserve(i32 extra) {
+        if (count + extra + 1 <= cap) return;
+
+        i32 new_cap = cap == 0 ? STR_FORMAT_GUESS : cap;
+        while (new_cap < count + extra + 1) new_cap *= 2;
+        items = arena_realloc<u8>(arena, items, cap, new_cap);
+        cap = new_cap;
+    }
+
+    void append(const char *text, i32 n) {
+        reserve(n);
+        memcpy(items + count, text, n);
+        count += n;
+        items[count] = 0;
+    }
+
+    void append(const char *text) {
+        append(text, (i32)strlen(text));
+    }
+
+    void append(char c) {
+        reserve(1);
+        items[count++] = c;
+        items[count] = 0;
+    }
+
+    template <typename... Args>
+    void appendf(const char *const format, Args... args) {
+        i32 room = cap - count;
+        i32 n = room > 0 ? snprintf(items + count, room, format, args...) : snprintf(NULL, 0, format, args...);
+        assert(n >= 0 && "Invalid format string!");
+
+        if (n >= room) {
+            reserve(n);
+            snprintf(items + count, n + 1, format, args...);
+        }
+        count += n;
+    }
+
+    void clear() {
+        count = 0;
+        if (items != NULL) items[0] = 0;
+    }
+
+    const char *c_str() const {
+        return items != NULL ? items : "";
+    }
+
+    // Gives the unused tail back when the text is still the arena top
+    const char *finish() {
+        if (items != NULL && arena_resize_top(arena, items, cap, count + 1)) {
+            cap = count + 1;
+        }
+        return c_str();
+    }
+};
+
+inline StrBuilder make_builder(GrowingArena *arena) {
+    return StrBuilder{NULL, 0, 0, arena};
+}
+
+// :intern
+struct StrInternSlot {
+    u64 hash;
+    const u8 *key;
+    i32 key_len;
+    bool formatted; // key is a format pointer plus its arguments instead of the text
+    const char *str;
+};
+
+// Open addressing table of strings that live in the arena, equal text gives the same pointer back
+struct StrIntern {
+    GrowingArena *arena;
+    StrInternSlot *slots;
+    i32 cap;
+    i32 count;
+};
+
+inline u64 str_hash(const void *data, i32 len) {
+    // FNV-1a
+    const unsigned char *bytes = (const unsigned char *)data;
+    u64 hash = 14695981039346656037ull;
+    for (i32 i = 0; i < len; i += 1) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+inline StrInternSlot *str_intern_find(StrIntern *self, u64 hash, const u8 *key, i32 key_len, bool formatted) {
+    u64 mask = self->cap - 1;
+    for (u64 i = hash & mask;; i = (i + 1) & mask) {
+        StrInternSlot *slot = &self->slots[i];
+        if (slot->str == NULL) return slot;
+        if (slot->hash == hash && slot->key_len == key_len && slot->formatted == formatted &&
+            memcmp(slot->key, key, key_len) == 0) {
+            return slot;
+        }
+    }
+}
+
+inline void str_intern_grow(StrIntern *self) {
+    StrInternSlot *old = self->slots;
+    i32 old_cap = self->cap;
+
+    self->cap = old_cap == 0 ? STR_INTERN_INITIAL_CAP : old_cap * 2;
+    self->slots = arena_alloc<StrInternSlot>(self->arena, sizeof(StrInternSlot) * self->cap);
+    memset(self->slots, 0, sizeof(StrInternSlot) * self->cap);
+
+    for (i32 i = 0; i < old_cap; i += 1) {
+        if (old[i].str == NULL) continue;
+        *str_intern_find(self, old[i].hash, old[i].key, old[i].key_len, old[i].formatted) = old[i];
+    }
+    arena_release(self->arena, old, sizeof(StrInternSlot) * old_cap);
+}
+
+// Slot for the key, the table grows first so there is always room for a new entry
+inline StrInternSlot *str_intern_slot(StrIntern *self, u64 hash, const u8 *key, i32 key_len, bool formatted) {
+    if ((self->count + 1) * 10 > self->cap * 7) {
+        str_intern_grow(self);
+    }
+    return str_intern_find(self, hash, key, key_len, formatted);
+}
+
+inline const char *str_intern(StrIntern *self, const char *text, i32 len) {
+    u64 hash = str_hash(text, len);
+    StrInternSlot *slot = str_intern_slot(self, hash, text, len, false);
+    if (slot->str != NULL) return slot->str;
+
+    u8 *copy = arena_alloc<u8>(self->arena, len + 1);
+    memcpy(copy, text, len);
+    copy[len] = 0;
+
+    *slot = StrInternSlot{hash, copy, len, false, copy};
+    self->count += 1;
+    return copy;
+}
+
+inline const char *str_intern(StrIntern *self, const char *text) {
+    return str_intern(self, text, (i32)strlen(text));
+}
+
+template <typename T>
+inline void str_key_push(u8 *key, i32 *len, T value) {
+    static_assert(std::is_trivially_copyable<T>::value, "Format arguments are keyed by value");
+    assert(*len + (i32)sizeof(T) <= STR_KEY_MAX && "Too many format arguments to intern");
+    memcpy(key + *len, &value, sizeof(T));
+    *len += sizeof(T);
+}
+
+// Formats once per distinct (format, arguments) and hands the same pointer back afterwards.
+// note: arguments are keyed by value, so %s needs pointers that stay put (literals or interned text)
+template <typename... Args>
+static const char *str_internf(StrIntern *self, const char *const format, Args... args) {
+    u8 key[STR_KEY_MAX];
+    i32 len = 0;
+    str_key_push(key, &len, format);
+    (str_key_push(key, &len, args), ...);
+
+    u64 hash = str_hash(key, len);
+    StrInternSlot *slot = str_intern_slot(self, hash, key, len, true);
+    if (slot->str != NULL) return slot->str;
+
+    const char *str = arena_sprintf(self->arena, format, args...);
+    u8 *stored = arena_alloc<u8>(self->arena, len);
+    memcpy(stored, key, len);
+
+    *slot = StrInternSlot{hash, stored, len, true, str};
+    self->count += 1;
+    return str;
+}
@@ -2,7 +2,9 @@
 
 typedef unsigned int u32;
 typedef unsigned long long u64;
+typedef signed char i8;
 typedef int i32;
+typedef long long i64;
 typedef float f32;
 typedef const char* cstring;
 typedef void* rawptr;